@@ -0,0 +1,98 @@
+#ifndef BUFFER_STORAGE_HPP
+#define BUFFER_STORAGE_HPP
+
+#include <array>
+#include <cstdint>
+#include <algorithm>
+
+namespace Xerxes
+{
+
+
+/**
+ * @brief Fixed size storage for buffers, size is known at compile time
+ *
+ * Backed by std::array, so the memory is reserved statically and is visible
+ * in the linker map. No heap is used.
+ *
+ * @tparam T - type of the stored elements
+ * @tparam N - number of elements, 0 selects heap allocated storage
+ */
+template <class T, uint32_t N>
+class BufferStorage
+{
+private:
+    std::array<T, N> storage {};
+
+public:
+    BufferStorage() {}
+
+    T & operator[](const uint32_t i) { return storage[i]; }
+    const T & operator[](const uint32_t i) const { return storage[i]; }
+
+    T* data() { return storage.data(); }
+    const T* data() const { return storage.data(); }
+
+    constexpr uint32_t size() const { return N; }
+};
+
+
+/**
+ * @brief Heap allocated storage for buffers, size is set at runtime
+ *
+ * Memory is allocated once in the constructor and released in the destructor,
+ * copies are deep.
+ *
+ * @tparam T - type of the stored elements
+ */
+template <class T>
+class BufferStorage<T, 0>
+{
+private:
+    T* storage {nullptr};
+    uint32_t length {0};
+
+public:
+    BufferStorage() {}
+
+    BufferStorage(const uint32_t &length) : length(length)
+    {
+        storage = new T[length]{};
+    }
+
+    BufferStorage(const BufferStorage &other) : length(other.length)
+    {
+        storage = new T[length]{};
+        std::copy(other.storage, other.storage + length, storage);
+    }
+
+    BufferStorage & operator=(const BufferStorage &other)
+    {
+        if(this != &other)
+        {
+            delete[] storage;
+            length = other.length;
+            storage = new T[length]{};
+            std::copy(other.storage, other.storage + length, storage);
+        }
+        return *this;
+    }
+
+    ~BufferStorage()
+    {
+        delete[] storage;
+    }
+
+    T & operator[](const uint32_t i) { return storage[i]; }
+    const T & operator[](const uint32_t i) const { return storage[i]; }
+
+    T* data() { return storage; }
+    const T* data() const { return storage; }
+
+    uint32_t size() const { return length; }
+};
+
+
+} // namespace Xerxes
+
+#endif // !BUFFER_STORAGE_HPP
@@ -0,0 +1,291 @@
+#ifndef INT_STATISTIC_BUFFER_HPP
+#define INT_STATISTIC_BUFFER_HPP
+
+#include <type_traits>
+
+#include "RingBuffer.hpp"
+#include "MonotonicQueue.hpp"
+#include "Moments.hpp"
+
+namespace Xerxes
+{
+
+
+/**
+ * @brief Ring buffer with statistics computed in integer arithmetic
+ *
+ * Intended for raw integer samples (ADC counts) on cores without FPU. Sum
+ * and sum of squares are kept in 64 bit integers and updated on every insert,
+ * which is exact, so they never drift. Mean and standard deviation are held
+ * in fixed point with FRAC_BITS fractional bits, conversion to float is done
+ * only in getStatistics() when the values are published.
+ *
+ * @note samples must fit into 24 bits (|x| < 2^24) and the window must not
+ * be longer than 2^14 samples, otherwise the sum of squares may overflow.
+ *
+ * @tparam T - integer type of the samples
+ * @tparam N - size of the buffer known at compile time, 0 = size given at runtime
+ */
+template <class T, uint32_t N = 0>
+class IntStatisticBuffer : public RingBuffer<T, N>
+{
+    static_assert(std::is_integral_v<T>, "IntStatisticBuffer needs integer samples");
+    static_assert(N <= (1 << 14), "IntStatisticBuffer window too long, sum of squares may overflow");
+
+public:
+    /// @brief number of fractional bits of mean and standard deviation
+    constexpr static uint8_t FRAC_BITS = Moments<T>::FRAC_BITS;
+
+protected:
+    T min {0};
+    T max {0};
+    int64_t meanQ {0};
+    uint32_t stdDevQ {0};
+
+    /// @brief sum and sum of squares of the elements in the window
+    Moments<T> moments;
+    /// @brief true if sums and queues describe current content of the buffer
+    bool runningValid {false};
+
+    /// @brief indices of window minimum candidates
+    MonotonicQueue<T, std::less<T>, N> minQueue;
+    /// @brief indices of window maximum candidates
+    MonotonicQueue<T, std::greater<T>, N> maxQueue;
+
+    /// @brief recompute sums and queues from the whole window
+    void resync();
+
+public:
+    IntStatisticBuffer();
+    IntStatisticBuffer(const uint32_t &maxSize) requires (N == 0);
+
+    /**
+     * @brief Insert one element and update sums and min/max queues in O(1)
+     *
+     * @param el element to insert
+     */
+    void insertOne(const T el);
+
+    /**
+     * @brief Insert block of elements, sums and queues are updated once per block
+     * 
+     * @param src first element of the block
+     * @param n number of elements in the block
+     */
+    void insertMany(const T* src, size_t n);
+
+    /**
+     * @brief Update mean and standard deviation, integer arithmetic only
+     */
+    void updateStatistics();
+
+    /// @brief mean of the window, fixed point with FRAC_BITS fractional bits
+    const int64_t & getMeanQ();
+    /// @brief standard deviation of the window, fixed point with FRAC_BITS fractional bits
+    const uint32_t & getStdDevQ();
+    const T & getMax();
+    const T & getMin();
+
+    /**
+     * @brief Publish statistics as floats
+     *
+     * @param min minimum of the window
+     * @param max maximum of the window
+     * @param mean mean of the window
+     * @param stdDev standard deviation of the window
+     * @param scale conversion factor from raw counts to published unit
+     */
+    void getStatistics(float* min, float* max, float* mean, float* stdDev, const float scale = 1.0f);
+};
+
+
+template <class T, uint32_t N>
+IntStatisticBuffer<T, N>::IntStatisticBuffer()
+{
+}
+
+
+template <class T, uint32_t N>
+IntStatisticBuffer<T, N>::IntStatisticBuffer(const uint32_t &maxSize) requires (N == 0) :
+    RingBuffer<T, N>(maxSize), minQueue(maxSize), maxQueue(maxSize)
+{
+}
+
+
+template <class T, uint32_t N>
+void IntStatisticBuffer<T, N>::insertOne(const T el)
+{
+    // if the window is full, the oldest element is overwritten by this insert
+    const bool evicting = this->maxCursor == this->capacity();
+    const uint32_t writePos = this->writePos();
+    const T evicted = this->buffer[writePos];
+
+    RingBuffer<T, N>::insertOne(el);
+
+    if(!runningValid)
+    {
+        // sums and queues are built lazily in updateStatistics()
+        return;
+    }
+
+    if(evicting)
+    {
+        moments.replace(evicted, el, this->maxCursor);
+    }
+    else
+    {
+        moments.add(el, this->maxCursor);
+    }
+
+    minQueue.evict(writePos);
+    maxQueue.evict(writePos);
+    minQueue.push(this->buffer.data(), writePos);
+    maxQueue.push(this->buffer.data(), writePos);
+}
+
+
+template <class T, uint32_t N>
+void IntStatisticBuffer<T, N>::insertMany(const T* src, size_t n)
+{
+    const uint32_t cap = this->capacity();
+
+    if(!runningValid || n >= cap)
+    {
+        // block replaces the whole window, rebuild from scratch in updateStatistics()
+        RingBuffer<T, N>::insertMany(src, n);
+        runningValid = false;
+        return;
+    }
+
+    const uint32_t start = this->writePos();
+
+    // old elements are still in place, update sums over the whole block
+    for(uint32_t i=0; i<n; i++)
+    {
+        uint32_t pos = start + i;
+        if(pos >= cap) pos -= cap;
+
+        const uint32_t count = this->maxCursor + i;
+        if(count >= cap)
+        {
+            moments.replace(this->buffer[pos], src[i], cap);
+        }
+        else
+        {
+            moments.add(src[i], count + 1);
+        }
+    }
+
+    RingBuffer<T, N>::insertMany(src, n);
+
+    // overwritten elements are the oldest ones, drop all of them before comparing new ones
+    for(uint32_t i=0; i<n; i++)
+    {
+        uint32_t pos = start + i;
+        if(pos >= cap) pos -= cap;
+
+        minQueue.evict(pos);
+        maxQueue.evict(pos);
+    }
+
+    for(uint32_t i=0; i<n; i++)
+    {
+        uint32_t pos = start + i;
+        if(pos >= cap) pos -= cap;
+
+        minQueue.push(this->buffer.data(), pos);
+        maxQueue.push(this->buffer.data(), pos);
+    }
+}
+
+
+template <class T, uint32_t N>
+void IntStatisticBuffer<T, N>::resync()
+{
+    moments.clear();
+    minQueue.clear();
+    maxQueue.clear();
+
+    // if the window is full, the oldest element is the next to be overwritten
+    const uint32_t oldest = this->maxCursor == this->capacity() ? this->writePos() : 0;
+
+    for(uint32_t i=0; i<this->maxCursor; i++)
+    {
+        uint32_t idx = oldest + i;
+        if(idx >= this->capacity()) idx -= this->capacity();
+
+        moments.add(this->buffer[idx], i + 1);
+
+        minQueue.push(this->buffer.data(), idx);
+        maxQueue.push(this->buffer.data(), idx);
+    }
+
+    runningValid = true;
+}
+
+
+template <class T, uint32_t N>
+void IntStatisticBuffer<T, N>::updateStatistics()
+{
+    if(!runningValid)
+    {
+        resync();
+    }
+
+    const uint32_t n = this->maxCursor;
+    if(n == 0)
+    {
+        return;
+    }
+
+    min = this->buffer[minQueue.front()];
+    max = this->buffer[maxQueue.front()];
+
+    meanQ = moments.meanQ(n);
+    stdDevQ = moments.stdDevQ(n);
+}
+
+
+template <class T, uint32_t N>
+const int64_t & IntStatisticBuffer<T, N>::getMeanQ()
+{
+    return meanQ;
+}
+
+
+template <class T, uint32_t N>
+const uint32_t & IntStatisticBuffer<T, N>::getStdDevQ()
+{
+    return stdDevQ;
+}
+
+
+template <class T, uint32_t N>
+const T & IntStatisticBuffer<T, N>::getMin()
+{
+    return min;
+}
+
+
+template <class T, uint32_t N>
+const T & IntStatisticBuffer<T, N>::getMax()
+{
+    return max;
+}
+
+
+template <class T, uint32_t N>
+void IntStatisticBuffer<T, N>::getStatistics(float* min, float* max, float* mean, float* stdDev, const float scale)
+{
+    constexpr float qToFloat = 1.0f / (1 << FRAC_BITS);
+
+    *min = this->min * scale;
+    *max = this->max * scale;
+    *mean = meanQ * (qToFloat * scale);
+    *stdDev = stdDevQ * (qToFloat * scale);
+}
+
+
+} // namespace Xerxes
+
+#endif // !INT_STATISTIC_BUFFER_HPP
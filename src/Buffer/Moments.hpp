@@ -0,0 +1,230 @@
+#ifndef MOMENTS_HPP
+#define MOMENTS_HPP
+
+#include <cstdint>
+#include <cmath>
+#include <concepts>
+
+namespace Xerxes
+{
+
+
+/**
+ * @brief Integer square root, floor(sqrt(x))
+ *
+ * Bitwise method, uses only shifts and additions - no FPU needed.
+ *
+ * @param x input value
+ * @return uint32_t floor of the square root of x
+ */
+constexpr uint32_t isqrt(uint64_t x)
+{
+    uint64_t result {0};
+    uint64_t bit = 1ULL << 62;
+
+    // find highest power of four not greater than x
+    while(bit > x)
+    {
+        bit >>= 2;
+    }
+
+    while(bit)
+    {
+        if(x >= result + bit)
+        {
+            x -= result + bit;
+            result = (result >> 1) + bit;
+        }
+        else
+        {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return static_cast<uint32_t>(result);
+}
+
+
+/**
+ * @brief Running mean and variance of a sliding window, floating point samples
+ *
+ * Welford's method extended to a sliding window. Rounding errors accumulate
+ * over time, owner should rebuild the moments from the window periodically.
+ *
+ * @tparam T - type of the samples
+ */
+template <class T>
+class Moments
+{
+private:
+    double mean {0};
+    /// @brief sum of squared deviations from the mean (M2 in Welford's method)
+    double m2 {0};
+
+public:
+    /// @brief accumulated values are exact, no periodic rebuild needed
+    constexpr static bool exact = false;
+
+    void clear()
+    {
+        mean = 0;
+        m2 = 0;
+    }
+
+    /**
+     * @brief Add sample to a growing window
+     *
+     * @param x new sample
+     * @param n number of samples in the window including x
+     */
+    void add(const T x, const uint32_t n)
+    {
+        const double delta = x - mean;
+        mean += delta / n;
+        m2 += delta * (x - mean);
+    }
+
+    /**
+     * @brief Replace the oldest sample of a full window
+     *
+     * @param old evicted sample
+     * @param x new sample
+     * @param n number of samples in the window
+     */
+    void replace(const T old, const T x, const uint32_t n)
+    {
+        const double oldMean = mean;
+        mean += (static_cast<double>(x) - old) / n;
+        m2 += (static_cast<double>(x) - old) * (x - mean + old - oldMean);
+    }
+
+    /**
+     * @brief Convert moments to published values
+     *
+     * @param n number of samples in the window
+     * @param mean mean of the window
+     * @param stdDev standard deviation of the window
+     * @param scale conversion factor to published unit
+     */
+    void publish(const uint32_t n, float* mean, float* stdDev, const float scale = 1.0f) const
+    {
+        // M2 can drop slightly below zero due to rounding
+        const double m2 = this->m2 > 0 ? this->m2 : 0;
+
+        *mean = this->mean * scale;
+        *stdDev = sqrtf(m2 / n) * scale;
+    }
+};
+
+
+/**
+ * @brief Running sum and sum of squares of a sliding window, integer samples
+ *
+ * Sums are kept in 64 bit integers and are exact. Mean and standard deviation
+ * are calculated in fixed point with FRAC_BITS fractional bits, without FPU.
+ *
+ * @note samples must fit into 24 bits (|x| < 2^24) and the window must not
+ * be longer than 2^14 samples, otherwise the sum of squares may overflow.
+ *
+ * @tparam T - integer type of the samples
+ */
+template <std::integral T>
+class Moments<T>
+{
+private:
+    int64_t sum {0};
+    int64_t sumSq {0};
+
+public:
+    /// @brief accumulated values are exact, no periodic rebuild needed
+    constexpr static bool exact = true;
+
+    /// @brief number of fractional bits of mean and standard deviation
+    constexpr static uint8_t FRAC_BITS = 8;
+
+    static_assert(24 + FRAC_BITS <= 32, "standard deviation of 24 bit samples must fit into 32 bits");
+
+    void clear()
+    {
+        sum = 0;
+        sumSq = 0;
+    }
+
+    /// @brief Add sample to a growing window
+    void add(const T x, [[maybe_unused]] const uint32_t n)
+    {
+        sum += x;
+        sumSq += static_cast<int64_t>(x) * x;
+    }
+
+    /// @brief Replace the oldest sample of a full window
+    void replace(const T old, const T x, [[maybe_unused]] const uint32_t n)
+    {
+        sum += static_cast<int64_t>(x) - old;
+        sumSq += static_cast<int64_t>(x) * x - static_cast<int64_t>(old) * old;
+    }
+
+    /**
+     * @brief Mean of the window in fixed point
+     *
+     * @param n number of samples in the window
+     * @return int64_t mean with FRAC_BITS fractional bits
+     */
+    int64_t meanQ(const uint32_t n) const
+    {
+        return (sum * (1 << FRAC_BITS)) / static_cast<int64_t>(n);
+    }
+
+    /**
+     * @brief Standard deviation of the window in fixed point
+     *
+     * @param n number of samples in the window
+     * @return uint32_t standard deviation with FRAC_BITS fractional bits, saturates at UINT32_MAX
+     */
+    uint32_t stdDevQ(const uint32_t n) const
+    {
+        const int64_t len = n;
+
+        // n * variance = sumSq - sum^2 / n, sum^2 would overflow so split sum = q*n + r
+        const int64_t q = sum / len;
+        const int64_t r = sum % len;
+        int64_t m2 = sumSq - (q * q * len + 2 * q * r + r * r / len);
+        if(m2 < 0) m2 = 0;
+
+        // variance of 24 bit samples needs up to 48 integer bits, give it only as many
+        // fractional bits as fit into 64 bits and scale the square root by the rest
+        const uint64_t var = m2 / len;
+        const uint64_t rem = m2 % len;
+        uint8_t shift = 2 * FRAC_BITS;
+        while(shift && (var >> (64 - shift)))
+        {
+            shift -= 2;
+        }
+
+        const uint64_t varQ = (var << shift) + (rem << shift) / len;
+        const uint64_t stdDevQ = static_cast<uint64_t>(isqrt(varQ)) << (FRAC_BITS - shift / 2);
+        return stdDevQ > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(stdDevQ);
+    }
+
+    /**
+     * @brief Convert moments to published values, the only place where floats are used
+     *
+     * @param n number of samples in the window
+     * @param mean mean of the window
+     * @param stdDev standard deviation of the window
+     * @param scale conversion factor from raw counts to published unit
+     */
+    void publish(const uint32_t n, float* mean, float* stdDev, const float scale = 1.0f) const
+    {
+        constexpr float qToFloat = 1.0f / (1 << FRAC_BITS);
+
+        *mean = meanQ(n) * (qToFloat * scale);
+        *stdDev = stdDevQ(n) * (qToFloat * scale);
+    }
+};
+
+
+} // namespace Xerxes
+
+#endif // !MOMENTS_HPP
@@ -0,0 +1,153 @@
+#ifndef MONOTONIC_QUEUE_HPP
+#define MONOTONIC_QUEUE_HPP
+
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+
+#include "BufferStorage.hpp"
+
+namespace Xerxes
+{
+
+
+/**
+ * @brief Monotonic queue of ring buffer indices for sliding window min/max
+ *
+ * Holds indices into the ring buffer of elements that can still become
+ * the extreme of the window. Elements are ordered by age, values are kept
+ * monotonic according to Compare, so the front is always the extreme of
+ * the window. Each element is pushed and popped at most once, hence the
+ * cost is amortized O(1) per insert. Storage is reserved up front, insert
+ * path never allocates.
+ *
+ * @tparam T - type of the elements stored in the ring buffer
+ * @tparam Compare - std::less<T> for minimum, std::greater<T> for maximum
+ * @tparam N - size of the window known at compile time, 0 = size given at runtime
+ */
+template <class T, class Compare, uint32_t N = 0>
+class MonotonicQueue
+{
+private:
+    /// @brief 16 bit indices are enough for fixed windows up to 65536 samples
+    typedef std::conditional_t<(N > 0 && N <= 0x10000), uint16_t, uint32_t> index_t;
+
+    /// @brief ring of indices into the ring buffer
+    BufferStorage<index_t, N> slots;
+    uint32_t head {0};
+    uint32_t count {0};
+
+    Compare cmp {};
+
+public:
+    MonotonicQueue();
+
+    /**
+     * @brief Construct a new Monotonic Queue object
+     *
+     * @param capacity size of the window (length of the ring buffer)
+     */
+    MonotonicQueue(const uint32_t &capacity) requires (N == 0);
+
+    /// @brief Remove all indices
+    void clear();
+
+    /**
+     * @brief Element at idx leaves the window, drop it if it is the front
+     *
+     * @param idx index in the ring buffer which is being overwritten
+     */
+    void evict(const uint32_t idx);
+
+    /**
+     * @brief Push newly inserted element
+     *
+     * @param buffer ring buffer storage
+     * @param idx index of the new element in the ring buffer
+     * @param stride distance between consecutive elements, for interleaved storage
+     */
+    void push(const T* buffer, const uint32_t idx, const uint32_t stride = 1);
+
+    /// @brief true if no element is tracked
+    bool empty() const;
+
+    /// @brief index of the extreme element of the window
+    uint32_t front() const;
+};
+
+
+template <class T, class Compare, uint32_t N>
+MonotonicQueue<T, Compare, N>::MonotonicQueue()
+{
+}
+
+
+template <class T, class Compare, uint32_t N>
+MonotonicQueue<T, Compare, N>::MonotonicQueue(const uint32_t &capacity) requires (N == 0) : slots(capacity)
+{
+}
+
+
+template <class T, class Compare, uint32_t N>
+void MonotonicQueue<T, Compare, N>::clear()
+{
+    head = 0;
+    count = 0;
+}
+
+
+template <class T, class Compare, uint32_t N>
+void MonotonicQueue<T, Compare, N>::evict(const uint32_t idx)
+{
+    // oldest element of the window is always at the front, if it is tracked at all
+    if(count && slots[head] == idx)
+    {
+        head = head + 1 < slots.size() ? head + 1 : 0;
+        count--;
+    }
+}
+
+
+template <class T, class Compare, uint32_t N>
+void MonotonicQueue<T, Compare, N>::push(const T* buffer, const uint32_t idx, const uint32_t stride)
+{
+    const T el = buffer[idx * stride];
+
+    // drop elements from the back which can not be the extreme anymore
+    while(count)
+    {
+        uint32_t back = head + count - 1;
+        if(back >= slots.size()) back -= slots.size();
+
+        if(cmp(buffer[slots[back] * stride], el))
+        {
+            break;
+        }
+        count--;
+    }
+
+    uint32_t tail = head + count;
+    if(tail >= slots.size()) tail -= slots.size();
+
+    slots[tail] = idx;
+    count++;
+}
+
+
+template <class T, class Compare, uint32_t N>
+bool MonotonicQueue<T, Compare, N>::empty() const
+{
+    return count == 0;
+}
+
+
+template <class T, class Compare, uint32_t N>
+uint32_t MonotonicQueue<T, Compare, N>::front() const
+{
+    return slots[head];
+}
+
+
+} // namespace Xerxes
+
+#endif // !MONOTONIC_QUEUE_HPP
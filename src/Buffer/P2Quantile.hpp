@@ -0,0 +1,380 @@
+#ifndef P2_QUANTILE_HPP
+#define P2_QUANTILE_HPP
+
+#include <array>
+#include <cstdint>
+#include <algorithm>
+
+namespace Xerxes
+{
+
+
+/**
+ * @brief Streaming estimator of a single quantile, P-square algorithm
+ *
+ * Jain & Chlamtac P^2 algorithm. Five markers track minimum, p/2, p, (1+p)/2
+ * quantiles and maximum, their heights are adjusted by piecewise parabolic
+ * interpolation as samples arrive. Memory is constant and the cost per
+ * sample is O(1), no samples are stored.
+ */
+class P2Quantile
+{
+private:
+    /// @brief quantile to estimate, 0..1
+    float p;
+    /// @brief marker heights
+    std::array<float, 5> height {};
+    /// @brief actual marker positions, 1 based
+    std::array<int32_t, 5> pos {};
+    /// @brief desired marker positions
+    std::array<float, 5> desired {};
+    /// @brief increments of desired marker positions
+    std::array<float, 5> step {};
+    /// @brief number of samples inserted
+    uint32_t count {0};
+
+    /// @brief piecewise parabolic prediction of marker i moved by d
+    float parabolic(const uint8_t i, const int32_t d) const;
+
+    /// @brief linear prediction of marker i moved by d
+    float linear(const uint8_t i, const int32_t d) const;
+
+public:
+    /**
+     * @brief Construct a new P2Quantile object
+     *
+     * @param p quantile to estimate, 0.5 = median
+     */
+    P2Quantile(const float p = 0.5f);
+
+    /// @brief Forget all samples, keep the quantile
+    void clear();
+
+    /// @brief Set quantile to estimate, forgets all samples
+    void setQuantile(const float p);
+
+    /// @brief Quantile being estimated
+    float quantile() const;
+
+    /// @brief Insert one sample
+    void insert(const float x);
+
+    /// @brief Current estimate of the quantile, 0 if no sample was inserted
+    float get() const;
+
+    /// @brief number of samples inserted since clear
+    uint32_t size() const;
+};
+
+
+/**
+ * @brief Quantiles of several channels over tumbling windows
+ *
+ * Each channel runs one P2Quantile per requested quantile. After windowLen
+ * samples insert() reports the window complete, the owner latches the
+ * estimates for publishing with latch() and the estimators start over, so
+ * the published values always describe one complete window. publish() reads
+ * only the latched estimates, so the owner may insert() and setQuantiles()
+ * without holding the lock which guards latch() and publish().
+ *
+ * @note a window needs well over 1 / (1 - p) samples to tell quantile p from
+ * the maximum, eg. P99 over 128 samples is the maximum or the sample below it.
+ *
+ * @tparam CH - number of channels, at most 8 (one bit of the channel mask each)
+ * @tparam Q - number of quantiles per channel
+ */
+template <uint8_t CH, uint8_t Q>
+class StreamingQuantiles
+{
+    static_assert(CH > 0 && CH <= 8, "StreamingQuantiles supports 1 to 8 channels");
+
+private:
+    std::array<std::array<P2Quantile, Q>, CH> estimators;
+    /// @brief estimates of the last completed window
+    std::array<std::array<float, Q>, CH> latched {};
+    bool latchedValid {false};
+
+    uint32_t windowLen;
+    uint32_t count {0};
+
+public:
+    /**
+     * @brief Construct a new Streaming Quantiles object
+     *
+     * @param quantiles quantiles to estimate, 0..1
+     * @param windowLen number of samples per window
+     */
+    StreamingQuantiles(const std::array<float, Q> &quantiles, const uint32_t windowLen);
+
+    /**
+     * @brief Set quantiles to estimate, restarts the window if any of them changed
+     *
+     * Latched estimates of the previous quantiles are published until the
+     * first window of the new ones completes.
+     *
+     * @param quantiles Q quantiles, 0..1
+     */
+    void setQuantiles(const float* quantiles);
+
+    /**
+     * @brief Insert one sample per channel
+     *
+     * @param values CH samples, one per channel
+     * @param mask channels to update, bit n = channel n
+     * @return true if the window is complete, call latch() before the next insert
+     */
+    bool insert(const float* values, const uint8_t mask);
+
+    /// @brief Latch estimates of the complete window for publishing and start a new window
+    void latch();
+
+    /**
+     * @brief Write quantiles of masked channels to the output array
+     *
+     * Output is laid out quantile by quantile, out[q * CH + ch], entries of
+     * channels outside the mask are left untouched. Nothing is written until
+     * the first window is latched.
+     *
+     * @param out Q * CH quantiles
+     * @param mask channels to publish, bit n = channel n
+     * @param scale conversion factor from samples to published unit
+     */
+    void publish(float* out, const uint8_t mask, const float scale = 1.0f) const;
+};
+
+
+inline P2Quantile::P2Quantile(const float p)
+{
+    setQuantile(p);
+}
+
+
+inline void P2Quantile::setQuantile(const float p)
+{
+    this->p = p;
+    step = {0, p / 2, p, (1 + p) / 2, 1};
+    clear();
+}
+
+
+inline float P2Quantile::quantile() const
+{
+    return p;
+}
+
+
+inline void P2Quantile::clear()
+{
+    count = 0;
+    pos = {1, 2, 3, 4, 5};
+    desired = {1, 1 + 2 * p, 1 + 4 * p, 3 + 2 * p, 5};
+}
+
+
+inline float P2Quantile::parabolic(const uint8_t i, const int32_t d) const
+{
+    const float nl = pos[i - 1], n = pos[i], nr = pos[i + 1];
+    const float ql = height[i - 1], q = height[i], qr = height[i + 1];
+
+    return q + d / (nr - nl) * ((n - nl + d) * (qr - q) / (nr - n) + (nr - n - d) * (q - ql) / (n - nl));
+}
+
+
+inline float P2Quantile::linear(const uint8_t i, const int32_t d) const
+{
+    return height[i] + d * (height[i + d] - height[i]) / (pos[i + d] - pos[i]);
+}
+
+
+inline void P2Quantile::insert(const float x)
+{
+    // first five samples initialize the markers
+    if(count < 5)
+    {
+        height[count++] = x;
+        if(count == 5)
+        {
+            std::sort(height.begin(), height.end());
+        }
+        return;
+    }
+    count++;
+
+    // find cell of the new sample, extend extremes if needed
+    uint8_t k;
+    if(x < height[0])
+    {
+        height[0] = x;
+        k = 0;
+    }
+    else if(x >= height[4])
+    {
+        height[4] = x;
+        k = 3;
+    }
+    else
+    {
+        k = 0;
+        while(x >= height[k + 1]) k++;
+    }
+
+    for(uint8_t i=k+1; i<5; i++)
+    {
+        pos[i]++;
+    }
+    for(uint8_t i=0; i<5; i++)
+    {
+        desired[i] += step[i];
+    }
+
+    // move inner markers towards their desired positions
+    for(uint8_t i=1; i<4; i++)
+    {
+        const float d = desired[i] - pos[i];
+        if((d >= 1 && pos[i + 1] - pos[i] > 1) || (d <= -1 && pos[i - 1] - pos[i] < -1))
+        {
+            const int32_t dir = d > 0 ? 1 : -1;
+            const float q = parabolic(i, dir);
+
+            height[i] = height[i - 1] < q && q < height[i + 1] ? q : linear(i, dir);
+            pos[i] += dir;
+        }
+    }
+}
+
+
+inline float P2Quantile::get() const
+{
+    if(count >= 5)
+    {
+        return height[2];
+    }
+
+    if(count == 0)
+    {
+        return 0;
+    }
+
+    // too few samples for markers, pick from the sorted samples, insertion sort of at most 4
+    std::array<float, 5> sorted = height;
+    for(uint32_t i=1; i<count; i++)
+    {
+        const float x = sorted[i];
+        uint32_t j = i;
+        for(; j > 0 && sorted[j - 1] > x; j--)
+        {
+            sorted[j] = sorted[j - 1];
+        }
+        sorted[j] = x;
+    }
+    return sorted[static_cast<uint32_t>(p * (count - 1) + 0.5f)];
+}
+
+
+inline uint32_t P2Quantile::size() const
+{
+    return count;
+}
+
+
+template <uint8_t CH, uint8_t Q>
+StreamingQuantiles<CH, Q>::StreamingQuantiles(const std::array<float, Q> &quantiles, const uint32_t windowLen) :
+    windowLen(windowLen)
+{
+    for(auto &channel : estimators)
+    {
+        for(uint8_t q=0; q<Q; q++)
+        {
+            channel[q].setQuantile(quantiles[q]);
+        }
+    }
+}
+
+
+template <uint8_t CH, uint8_t Q>
+void StreamingQuantiles<CH, Q>::setQuantiles(const float* quantiles)
+{
+    bool changed = false;
+    for(uint8_t q=0; q<Q; q++)
+    {
+        changed = changed || estimators[0][q].quantile() != quantiles[q];
+    }
+
+    if(!changed)
+    {
+        return;
+    }
+
+    for(auto &channel : estimators)
+    {
+        for(uint8_t q=0; q<Q; q++)
+        {
+            channel[q].setQuantile(quantiles[q]);
+        }
+    }
+    count = 0;
+}
+
+
+template <uint8_t CH, uint8_t Q>
+bool StreamingQuantiles<CH, Q>::insert(const float* values, const uint8_t mask)
+{
+    for(uint8_t ch=0; ch<CH; ch++)
+    {
+        if(!(mask & (1 << ch)))
+        {
+            continue;
+        }
+
+        for(auto &estimator : estimators[ch])
+        {
+            estimator.insert(values[ch]);
+        }
+    }
+
+    return ++count >= windowLen;
+}
+
+
+template <uint8_t CH, uint8_t Q>
+void StreamingQuantiles<CH, Q>::latch()
+{
+    for(uint8_t ch=0; ch<CH; ch++)
+    {
+        for(uint8_t q=0; q<Q; q++)
+        {
+            latched[ch][q] = estimators[ch][q].get();
+            estimators[ch][q].clear();
+        }
+    }
+    latchedValid = true;
+    count = 0;
+}
+
+
+template <uint8_t CH, uint8_t Q>
+void StreamingQuantiles<CH, Q>::publish(float* out, const uint8_t mask, const float scale) const
+{
+    if(!latchedValid)
+    {
+        return;
+    }
+
+    for(uint8_t ch=0; ch<CH; ch++)
+    {
+        if(!(mask & (1 << ch)))
+        {
+            continue;
+        }
+
+        for(uint8_t q=0; q<Q; q++)
+        {
+            out[q * CH + ch] = latched[ch][q] * scale;
+        }
+    }
+}
+
+
+} // namespace Xerxes
+
+#endif // !P2_QUANTILE_HPP
@@ -2,97 +2,204 @@
 #define RINGBUFFER_HPP
 
 #include <array>
+#include <bit>
 #include <random>
 #include <cmath>
 #include <iostream>
 
+#include "BufferStorage.hpp"
+
 namespace Xerxes
 {
 
 
 /**
- * @brief Ring buffer class 
- * 
+ * @brief Round number of samples up to the length usable by fixed size buffers
+ *
+ * @param samples minimum number of samples in the window
+ * @return constexpr uint32_t nearest power of two which is not smaller than samples
+ */
+constexpr uint32_t ringBufferLen(const uint32_t samples)
+{
+    return std::bit_ceil(samples);
+}
+
+
+/**
+ * @brief Ring buffer class
+ *
  * This class implements a ring buffer. It is used to store the last n elements
  * of a stream of data. The buffer is implemented as a circular buffer.
- * 
+ *
+ * If N is set, the buffer is backed by std::array of N elements and N must be
+ * a power of two, wraparound is then done by masking the position without
+ * any branch. If N is 0, the buffer is allocated on the heap and its size is
+ * given at runtime.
+ *
  * @tparam T - type of the elements to be stored in the buffer
+ * @tparam N - size of the buffer known at compile time, 0 = size given at runtime
  */
-template <class T>
+template <class T, uint32_t N = 0>
 class RingBuffer
 {
-private:
-    uint32_t currentPos {0};
-    uint32_t maxSize;
+    static_assert((N & (N - 1)) == 0, "RingBuffer size must be a power of two");
+
 protected:
+    uint32_t currentPos {0};
     uint32_t maxCursor {0};
-    T* buffer;
+    BufferStorage<T, N> buffer;
     bool saturated {false};
 
+    /// @brief number of elements the buffer can hold
+    uint32_t capacity() const;
+
+    /// @brief position which will be written by the next insert
+    uint32_t writePos() const;
+
 public:
     RingBuffer();
-    RingBuffer(const uint32_t &maxSize);
+    RingBuffer(const uint32_t &maxSize) requires (N == 0);
     RingBuffer(std::initializer_list<T> il);
-    ~RingBuffer();
 
     void insertOne(const T el);
+
+    /**
+     * @brief Insert block of elements, same result as inserting them one by one
+     * 
+     * The block is copied in at most two contiguous segments, if it is longer
+     * than the buffer only its last elements are copied.
+     * 
+     * @param src first element of the block
+     * @param n number of elements in the block
+     */
+    void insertMany(const T* src, size_t n);
+
     const T & getLast();
 };
 
 
-template <class T>
-RingBuffer<T>::RingBuffer()
+template <class T, uint32_t N>
+RingBuffer<T, N>::RingBuffer()
 {
 }
 
 
-template <class T>
-RingBuffer<T>::RingBuffer(std::initializer_list<T> il) : currentPos(0)
+template <class T, uint32_t N>
+RingBuffer<T, N>::RingBuffer(std::initializer_list<T> il)
 {
-    size_t size = il.size();
-    maxSize = size;
-    buffer = new T[size]{};
-    int i = 0;
+    if constexpr (N == 0)
+    {
+        buffer = BufferStorage<T, N>(il.size());
+    }
+
     for(const auto el : il)
     {
-        buffer[i++] = el;
+        insertOne(el);
     }
-    maxCursor = size;
-    saturated = true;
 }
 
 
-template <class T>
-RingBuffer<T>::RingBuffer(const uint32_t &maxSize) : maxSize(maxSize), currentPos(0), maxCursor(0)
-{   
-    this->buffer = new T[maxSize]{0};
+template <class T, uint32_t N>
+RingBuffer<T, N>::RingBuffer(const uint32_t &maxSize) requires (N == 0) : buffer(maxSize)
+{
 }
 
-template <class T>
-RingBuffer<T>::~RingBuffer()
+
+template <class T, uint32_t N>
+uint32_t RingBuffer<T, N>::capacity() const
 {
-    // delete buffer; // TODO: uncomment this line !!!
+    return buffer.size();
 }
 
 
-template <class T>
-void RingBuffer<T>::insertOne(const T el)
+template <class T, uint32_t N>
+uint32_t RingBuffer<T, N>::writePos() const
 {
-    if(currentPos >= maxSize)
+    if constexpr (N > 0)
     {
-        currentPos = 0;
-        saturated = true;
+        return currentPos;
     }
+    else
+    {
+        return currentPos >= buffer.size() ? 0 : currentPos;
+    }
+}
 
-    this->buffer[currentPos++] = el;
-    if(currentPos > maxCursor) maxCursor = currentPos;
+
+template <class T, uint32_t N>
+void RingBuffer<T, N>::insertOne(const T el)
+{
+    if constexpr (N > 0)
+    {
+        buffer[currentPos] = el;
+        currentPos = (currentPos + 1) & (N - 1);
+        maxCursor += maxCursor < N;
+        saturated = maxCursor == N;
+    }
+    else
+    {
+        if(currentPos >= buffer.size())
+        {
+            currentPos = 0;
+            saturated = true;
+        }
+
+        this->buffer[currentPos++] = el;
+        if(currentPos > maxCursor) maxCursor = currentPos;
+    }
 }
 
 
-template <class T>
-const T & RingBuffer<T>::getLast()
+template <class T, uint32_t N>
+void RingBuffer<T, N>::insertMany(const T* src, size_t n)
 {
-    if(this->currentPos > 0)
+    const uint32_t cap = capacity();
+    if(n == 0 || cap == 0)
+    {
+        return;
+    }
+
+    // a write wraps around if it does not fit between current position and the end
+    const bool wraps = currentPos + n > cap;
+    maxCursor = maxCursor + n < cap ? maxCursor + n : cap;
+
+    uint32_t start = writePos();
+
+    // elements which would be overwritten within the block are skipped
+    if(n > cap)
+    {
+        start = (start + (n - cap)) % cap;
+        src += n - cap;
+        n = cap;
+    }
+
+    const uint32_t first = n < cap - start ? n : cap - start;
+    std::copy_n(src, first, buffer.data() + start);
+    std::copy_n(src + first, n - first, buffer.data());
+
+    const uint32_t end = start + n;
+    if constexpr (N > 0)
+    {
+        currentPos = end & (N - 1);
+        saturated = maxCursor == N;
+    }
+    else
+    {
+        // keep position at the end of the buffer, it is wrapped lazily by the next insert
+        currentPos = end > cap ? end - cap : end;
+        saturated = saturated || wraps;
+    }
+}
+
+
+template <class T, uint32_t N>
+const T & RingBuffer<T, N>::getLast()
+{
+    if constexpr (N > 0)
+    {
+        return this->buffer[(this->currentPos - 1) & (N - 1)];
+    }
+    else if(this->currentPos > 0)
     {
         return this->buffer[this->currentPos - 1];
     }
@@ -102,7 +209,7 @@ const T & RingBuffer<T>::getLast()
     }
 }
 
-    
+
 } // namespace Xerxes
 
-#endif // RINGBUFFER_HPP
\ No newline at end of file
+#endif // RINGBUFFER_HPP
@@ -0,0 +1,146 @@
+#ifndef SEQ_LOCK_BUFFER_HPP
+#define SEQ_LOCK_BUFFER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+namespace Xerxes
+{
+
+
+/**
+ * @brief Byte buffer published by one writer and read consistently by other cores, seqlock
+ *
+ * The writer copies a complete image into the buffer while the sequence number
+ * is odd. Readers copy out the requested range and retry if the sequence number
+ * was odd or changed meanwhile, so they always get bytes of a single image and
+ * never block the writer. Only plain atomic loads and stores are used, no
+ * read-modify-write, so it works on cores without atomic instructions.
+ *
+ * @note there must be only one writer at a time, serialize writers externally.
+ *
+ * @tparam N - size of the buffer in bytes
+ */
+template <uint32_t N>
+class SeqLockBuffer
+{
+private:
+    /// @brief even = stable, odd = write in progress
+    std::atomic<uint32_t> seq {0};
+    alignas(8) uint8_t data[N] {};
+
+public:
+    /**
+     * @brief Publish a new image
+     *
+     * @param src N bytes to publish
+     */
+    void write(const uint8_t* src);
+
+    /**
+     * @brief Publish a range of a new image, the rest stays as last published
+     *
+     * @param src N bytes of the image, only the range is copied
+     * @param offset first byte to publish
+     * @param len number of bytes to publish, offset + len <= N
+     */
+    void write(const uint8_t* src, const uint32_t offset, const uint32_t len);
+
+    /**
+     * @brief Copy a consistent range of the last published image
+     *
+     * @param dst destination, at least len bytes
+     * @param offset first byte to copy
+     * @param len number of bytes to copy, offset + len <= N
+     * @return uint32_t number of retries caused by concurrent writes
+     */
+    uint32_t read(uint8_t* dst, const uint32_t offset, const uint32_t len) const;
+
+    /**
+     * @brief Copy several ranges of the same published image
+     *
+     * @tparam F - callable as copy(const uint8_t* image)
+     * @param copy copies what it needs from the image, called again if a write interfered
+     * @return uint32_t number of retries caused by concurrent writes
+     */
+    template <class F>
+    uint32_t readWith(F copy) const;
+
+    /// @brief number of images published so far
+    uint32_t version() const;
+};
+
+
+template <uint32_t N>
+void SeqLockBuffer<N>::write(const uint8_t* src)
+{
+    const uint32_t s = seq.load(std::memory_order_relaxed);
+
+    seq.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    std::memcpy(data, src, N);
+
+    seq.store(s + 2, std::memory_order_release);
+}
+
+
+template <uint32_t N>
+void SeqLockBuffer<N>::write(const uint8_t* src, const uint32_t offset, const uint32_t len)
+{
+    const uint32_t s = seq.load(std::memory_order_relaxed);
+
+    seq.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    std::memcpy(data + offset, src + offset, len);
+
+    seq.store(s + 2, std::memory_order_release);
+}
+
+
+template <uint32_t N>
+uint32_t SeqLockBuffer<N>::read(uint8_t* dst, const uint32_t offset, const uint32_t len) const
+{
+    return readWith([&](const uint8_t* image)
+    {
+        std::memcpy(dst, image + offset, len);
+    });
+}
+
+
+template <uint32_t N>
+template <class F>
+uint32_t SeqLockBuffer<N>::readWith(F copy) const
+{
+    uint32_t retries = 0;
+
+    while(true)
+    {
+        const uint32_t before = seq.load(std::memory_order_acquire);
+        if(!(before & 1))
+        {
+            copy(data);
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if(seq.load(std::memory_order_relaxed) == before)
+            {
+                return retries;
+            }
+        }
+        retries++;
+    }
+}
+
+
+template <uint32_t N>
+uint32_t SeqLockBuffer<N>::version() const
+{
+    return seq.load(std::memory_order_acquire) / 2;
+}
+
+
+} // namespace Xerxes
+
+#endif // !SEQ_LOCK_BUFFER_HPP
@@ -0,0 +1,181 @@
+#ifndef SPSC_RING_HPP
+#define SPSC_RING_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <span>
+
+namespace Xerxes
+{
+
+
+/**
+ * @brief Lock-free ring for one producer and one consumer, e.g. on different cores
+ *
+ * Head and tail are free running counters, each written by one side only, so
+ * only plain atomic loads and stores with acquire/release ordering are needed,
+ * no spinlock and no read-modify-write. Elements are copied before the counter
+ * is published, so the other side never sees a slot which is not complete.
+ *
+ * @note exactly one producer calls push, exactly one consumer calls pop.
+ *
+ * @tparam T - type of the elements, trivially copyable
+ * @tparam N - number of elements, power of two
+ */
+template <class T, uint32_t N>
+class SpscRing
+{
+    static_assert(N && !(N & (N - 1)), "N must be a power of two");
+
+private:
+    /// @brief elements pushed so far, written by the producer
+    std::atomic<uint32_t> head {0};
+    /// @brief elements popped so far, written by the consumer
+    std::atomic<uint32_t> tail {0};
+    T data[N] {};
+
+public:
+    /**
+     * @brief Append one element
+     *
+     * @param el element to append
+     * @return true if the element was appended
+     * @return false if the ring is full
+     */
+    bool push(const T &el);
+
+    /**
+     * @brief Append as many elements as fit
+     *
+     * @param src elements to append
+     * @return uint32_t number of elements appended, from the front of src
+     */
+    uint32_t push(std::span<const T> src);
+
+    /**
+     * @brief Remove the oldest element
+     *
+     * @param el removed element
+     * @return true if an element was removed
+     * @return false if the ring is empty
+     */
+    bool pop(T &el);
+
+    /**
+     * @brief Remove up to dst.size() oldest elements
+     *
+     * @param dst destination
+     * @return uint32_t number of elements removed
+     */
+    uint32_t pop(std::span<T> dst);
+
+    /// @brief number of elements ready to be popped
+    uint32_t size() const;
+
+    /// @brief number of elements which can be pushed
+    uint32_t free() const;
+
+    /// @brief true if there is nothing to pop
+    bool empty() const;
+
+    /// @brief true if there is no space to push
+    bool full() const;
+
+    /// @brief drop all elements, called by the consumer
+    void clear();
+
+    /// @brief maximum number of elements
+    static constexpr uint32_t capacity() { return N; }
+};
+
+
+template <class T, uint32_t N>
+bool SpscRing<T, N>::push(const T &el)
+{
+    return push(std::span<const T>(&el, 1)) == 1;
+}
+
+
+template <class T, uint32_t N>
+uint32_t SpscRing<T, N>::push(std::span<const T> src)
+{
+    const uint32_t h = head.load(std::memory_order_relaxed);
+    // slots are reused only after the consumer has published that it read them
+    const uint32_t space = N - (h - tail.load(std::memory_order_acquire));
+    const uint32_t count = src.size() < space ? src.size() : space;
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+        data[(h + i) & (N - 1)] = src[i];
+    }
+
+    head.store(h + count, std::memory_order_release);
+    return count;
+}
+
+
+template <class T, uint32_t N>
+bool SpscRing<T, N>::pop(T &el)
+{
+    return pop(std::span<T>(&el, 1)) == 1;
+}
+
+
+template <class T, uint32_t N>
+uint32_t SpscRing<T, N>::pop(std::span<T> dst)
+{
+    const uint32_t t = tail.load(std::memory_order_relaxed);
+    // elements are read only after the producer has published that it wrote them
+    const uint32_t ready = head.load(std::memory_order_acquire) - t;
+    const uint32_t count = dst.size() < ready ? dst.size() : ready;
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+        dst[i] = data[(t + i) & (N - 1)];
+    }
+
+    tail.store(t + count, std::memory_order_release);
+    return count;
+}
+
+
+template <class T, uint32_t N>
+uint32_t SpscRing<T, N>::size() const
+{
+    // tail first, head can only be ahead of it later on
+    const uint32_t t = tail.load(std::memory_order_acquire);
+    return head.load(std::memory_order_acquire) - t;
+}
+
+
+template <class T, uint32_t N>
+uint32_t SpscRing<T, N>::free() const
+{
+    return N - size();
+}
+
+
+template <class T, uint32_t N>
+bool SpscRing<T, N>::empty() const
+{
+    return size() == 0;
+}
+
+
+template <class T, uint32_t N>
+bool SpscRing<T, N>::full() const
+{
+    return size() == N;
+}
+
+
+template <class T, uint32_t N>
+void SpscRing<T, N>::clear()
+{
+    tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+
+} // namespace Xerxes
+
+#endif // !SPSC_RING_HPP
@@ -0,0 +1,258 @@
+#ifndef STATISTIC_BANK_HPP
+#define STATISTIC_BANK_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+
+#include "Moments.hpp"
+#include "MonotonicQueue.hpp"
+
+namespace Xerxes
+{
+
+
+/**
+ * @brief Sliding window statistics of several channels sampled together
+ *
+ * Samples of all channels taken at the same time are stored next to each
+ * other (interleaved), so one insert touches a single row of memory and all
+ * active channels are updated in one pass. Each channel has its own running
+ * moments and min/max queues, inactive channels cost nothing but memory.
+ *
+ * Floating point channels use Welford's method and are rebuilt from the
+ * window once per wrap to get rid of rounding drift, integer channels keep
+ * exact sums in fixed point and need no rebuild.
+ *
+ * @tparam CH - number of channels, at most 8 (one bit of the channel mask each)
+ * @tparam N - length of the window, must be a power of two
+ * @tparam T - type of the samples
+ */
+template <uint8_t CH, uint32_t N, class T = float>
+class StatisticBank
+{
+    static_assert(CH > 0 && CH <= 8, "StatisticBank supports 1 to 8 channels");
+    static_assert(N > 0 && (N & (N - 1)) == 0, "StatisticBank length must be a power of two");
+    static_assert(!std::is_integral_v<T> || N <= (1 << 14), "StatisticBank window too long, sum of squares may overflow");
+
+private:
+    /// @brief samples, row = one insert, column = channel
+    std::array<T, N * CH> samples {};
+    /// @brief row which will be written by the next insert
+    uint32_t currentPos {0};
+    /// @brief number of rows in the window
+    uint32_t count {0};
+    /// @brief channels whose moments and queues describe the window
+    uint8_t validMask {0};
+
+    std::array<Moments<T>, CH> moments {};
+    std::array<MonotonicQueue<T, std::less<T>, N>, CH> minQueues {};
+    std::array<MonotonicQueue<T, std::greater<T>, N>, CH> maxQueues {};
+
+    /// @brief rebuild moments and queues of the channel from the whole window
+    void resync(const uint8_t ch);
+
+public:
+    StatisticBank();
+
+    /**
+     * @brief Insert one sample per channel
+     *
+     * All channels are stored, statistics are updated only for channels in
+     * the mask. A channel which was not in the mask in previous inserts is
+     * rebuilt from the window.
+     *
+     * @param values CH samples, one per channel
+     * @param mask channels to update, bit n = channel n
+     */
+    void insert(const T* values, const uint8_t mask);
+
+    /**
+     * @brief Insert a block of rows, eg. from a burst read
+     *
+     * Same result as inserting the rows one by one. A block at least as long
+     * as the window is copied in at once and the masked channels are rebuilt
+     * a single time instead of being updated row by row.
+     *
+     * @param rows n rows of CH samples each, oldest first
+     * @param n number of rows
+     * @param mask channels to update, bit n = channel n
+     */
+    void insertMany(const T* rows, const uint32_t n, const uint8_t mask);
+
+    /**
+     * @brief Write statistics of masked channels to the output arrays
+     *
+     * Arrays are indexed by channel, entries of channels outside the mask
+     * are left untouched, so they can point directly into the register map.
+     *
+     * @param mean mean of each channel
+     * @param stdDev standard deviation of each channel
+     * @param min minimum of each channel
+     * @param max maximum of each channel
+     * @param mask channels to publish, bit n = channel n
+     * @param scale conversion factor from samples to published unit
+     */
+    void publish(float* mean, float* stdDev, float* min, float* max, const uint8_t mask, const float scale = 1.0f);
+
+    /// @brief number of samples per channel in the window
+    uint32_t size() const;
+};
+
+
+template <uint8_t CH, uint32_t N, class T>
+StatisticBank<CH, N, T>::StatisticBank()
+{
+}
+
+
+template <uint8_t CH, uint32_t N, class T>
+void StatisticBank<CH, N, T>::insert(const T* values, const uint8_t mask)
+{
+    const bool evicting = count == N;
+    const uint32_t pos = currentPos;
+    // floating point moments are rebuilt whenever the window wraps around
+    const bool rebuild = !Moments<T>::exact && evicting && pos == 0;
+
+    currentPos = (pos + 1) & (N - 1);
+    count += count < N;
+
+    T* row = &samples[pos * CH];
+    uint8_t resyncMask {0};
+
+    for(uint8_t ch=0; ch<CH; ch++)
+    {
+        const T old = row[ch];
+        const T x = values[ch];
+        row[ch] = x;
+
+        const uint8_t bit = 1 << ch;
+        if(!(mask & bit))
+        {
+            validMask &= ~bit;
+            continue;
+        }
+
+        if(rebuild || !(validMask & bit))
+        {
+            resyncMask |= bit;
+            continue;
+        }
+
+        if(evicting)
+        {
+            moments[ch].replace(old, x, count);
+        }
+        else
+        {
+            moments[ch].add(x, count);
+        }
+
+        minQueues[ch].evict(pos);
+        maxQueues[ch].evict(pos);
+        minQueues[ch].push(samples.data() + ch, pos, CH);
+        maxQueues[ch].push(samples.data() + ch, pos, CH);
+    }
+
+    for(uint8_t ch=0; resyncMask; ch++, resyncMask >>= 1)
+    {
+        if(resyncMask & 1)
+        {
+            resync(ch);
+        }
+    }
+}
+
+
+template <uint8_t CH, uint32_t N, class T>
+void StatisticBank<CH, N, T>::insertMany(const T* rows, const uint32_t n, const uint8_t mask)
+{
+    if(n < N)
+    {
+        // older rows stay in the window, slide the statistics row by row
+        for(uint32_t i=0; i<n; i++)
+        {
+            insert(rows + i * CH, mask);
+        }
+        return;
+    }
+
+    // block replaces the whole window, only its last N rows matter
+    std::copy(rows + (n - N) * CH, rows + n * CH, samples.begin());
+    currentPos = 0;
+    count = N;
+    validMask = 0;
+
+    for(uint8_t ch=0; ch<CH; ch++)
+    {
+        if(mask & (1 << ch))
+        {
+            resync(ch);
+        }
+    }
+}
+
+
+template <uint8_t CH, uint32_t N, class T>
+void StatisticBank<CH, N, T>::resync(const uint8_t ch)
+{
+    moments[ch].clear();
+    minQueues[ch].clear();
+    maxQueues[ch].clear();
+
+    // if the window is full, the oldest row is the next to be overwritten
+    const uint32_t oldest = count == N ? currentPos : 0;
+
+    for(uint32_t i=0; i<count; i++)
+    {
+        const uint32_t idx = (oldest + i) & (N - 1);
+
+        moments[ch].add(samples[idx * CH + ch], i + 1);
+        minQueues[ch].push(samples.data() + ch, idx, CH);
+        maxQueues[ch].push(samples.data() + ch, idx, CH);
+    }
+
+    validMask |= 1 << ch;
+}
+
+
+template <uint8_t CH, uint32_t N, class T>
+void StatisticBank<CH, N, T>::publish(float* mean, float* stdDev, float* min, float* max, const uint8_t mask, const float scale)
+{
+    if(count == 0)
+    {
+        return;
+    }
+
+    for(uint8_t ch=0; ch<CH; ch++)
+    {
+        const uint8_t bit = 1 << ch;
+        if(!(mask & bit))
+        {
+            continue;
+        }
+
+        if(!(validMask & bit))
+        {
+            resync(ch);
+        }
+
+        moments[ch].publish(count, &mean[ch], &stdDev[ch], scale);
+        min[ch] = samples[minQueues[ch].front() * CH + ch] * scale;
+        max[ch] = samples[maxQueues[ch].front() * CH + ch] * scale;
+    }
+}
+
+
+template <uint8_t CH, uint32_t N, class T>
+uint32_t StatisticBank<CH, N, T>::size() const
+{
+    return count;
+}
+
+
+} // namespace Xerxes
+
+#endif // !STATISTIC_BANK_HPP
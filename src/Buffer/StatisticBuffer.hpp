@@ -2,23 +2,98 @@
 #define STATISTIC_BUFFER_HPP
 
 #include "RingBuffer.hpp"
+#include "MonotonicQueue.hpp"
 
 namespace Xerxes
 {
 
 
-template <class T>
-class StatisticBuffer : public RingBuffer<T>
+/**
+ * @brief Ring buffer with statistics over the stored window
+ * 
+ * Mean and standard deviation are maintained incrementally (Welford's method
+ * extended to a sliding window) on every insert, so updateStatistics() does
+ * not need to rescan the window for them. Running sums are recomputed from
+ * scratch once per window wrap to cancel accumulated rounding errors, which
+ * keeps the cost amortized O(1) per sample. Minimum and maximum are tracked
+ * with monotonic queues, so they are amortized O(1) per sample as well.
+ * 
+ * @tparam T - type of the elements to be stored in the buffer
+ * @tparam N - size of the buffer known at compile time, 0 = size given at runtime
+ */
+template <class T, uint32_t N = 0>
+class StatisticBuffer : public RingBuffer<T, N>
 {
 protected:
     float min;
     float max;
     float mean;
     float stdDev;
+
+    /// @brief running mean of the window, maintained by insertOne()
+    double runningMean {0};
+    /// @brief running sum of squared deviations from the mean (M2 in Welford's method)
+    double runningM2 {0};
+    /// @brief true if running sums and queues describe current content of the buffer
+    bool runningValid {false};
+
+    /// @brief indices of window minimum candidates
+    MonotonicQueue<T, std::less<T>, N> minQueue;
+    /// @brief indices of window maximum candidates
+    MonotonicQueue<T, std::greater<T>, N> maxQueue;
+
+    /// @brief recompute running sums from the whole window
+    void resyncRunning();
+
+    /**
+     * @brief Add element to running sums
+     * 
+     * @param x new element
+     * @param old element replaced by x, if evicting
+     * @param evicting true if the window is full and old leaves it
+     * @param count number of elements in the window including x
+     */
+    void updateRunning(const double x, const double old, const bool evicting, const uint32_t count);
+
+    /// @brief rebuild min/max queues from the whole window, oldest element first
+    void rebuildExtrema();
+
 public:
-    using RingBuffer<T>::RingBuffer; // inherit constructors
+    StatisticBuffer();
+    StatisticBuffer(const uint32_t &maxSize) requires (N == 0);
+    StatisticBuffer(std::initializer_list<T> il);
+
+    /**
+     * @brief Insert one element and update running sums in O(1)
+     * 
+     * @param el element to insert
+     */
+    void insertOne(const T el);
+
+    /**
+     * @brief Insert block of elements, running sums and queues are updated once per block
+     * 
+     * Running sums are updated from the old and new elements before the block
+     * is copied in, min/max queues drop the overwritten elements and take the
+     * new ones after the copy. A block as long as the window rebuilds them.
+     * 
+     * @param src first element of the block
+     * @param n number of elements in the block
+     */
+    void insertMany(const T* src, size_t n);
+
+    /**
+     * @brief Update statistics from running sums and min/max queues
+     */
     void updateStatistics();
 
+    /**
+     * @brief Update statistics with full two-pass rescan of the window
+     * 
+     * Slow, O(n), kept as a reference for the incremental computation.
+     */
+    void recalculateStatistics();
+
     const float & getMean();
     const float & getStdDev();
     const float & getMax();
@@ -27,8 +102,33 @@ public:
 };
 
 
-template <class T>
-void StatisticBuffer<T>::getStatistics(T* min, T* max, T* mean, T* stdDev)
+template <class T, uint32_t N>
+StatisticBuffer<T, N>::StatisticBuffer()
+{
+}
+
+
+template <class T, uint32_t N>
+StatisticBuffer<T, N>::StatisticBuffer(const uint32_t &maxSize) requires (N == 0) : 
+    RingBuffer<T, N>(maxSize), minQueue(maxSize), maxQueue(maxSize)
+{
+}
+
+
+template <class T, uint32_t N>
+StatisticBuffer<T, N>::StatisticBuffer(std::initializer_list<T> il) : 
+    RingBuffer<T, N>(il)
+{
+    if constexpr (N == 0)
+    {
+        minQueue = MonotonicQueue<T, std::less<T>, N>(il.size());
+        maxQueue = MonotonicQueue<T, std::greater<T>, N>(il.size());
+    }
+}
+
+
+template <class T, uint32_t N>
+void StatisticBuffer<T, N>::getStatistics(T* min, T* max, T* mean, T* stdDev)
 {
     *min = this->min;
     *max = this->max;
@@ -37,8 +137,184 @@ void StatisticBuffer<T>::getStatistics(T* min, T* max, T* mean, T* stdDev)
 }
 
 
-template <class T>
-void StatisticBuffer<T>::updateStatistics()
+template <class T, uint32_t N>
+void StatisticBuffer<T, N>::insertOne(const T el)
+{
+    // if the window is full, the oldest element is overwritten by this insert
+    const bool evicting = this->maxCursor == this->capacity();
+    const uint32_t writePos = this->writePos();
+    const bool wraps = evicting && writePos == 0;
+    const T evicted = this->buffer[writePos];
+
+    RingBuffer<T, N>::insertOne(el);
+
+    if(!runningValid)
+    {
+        // running sums and queues are built lazily in updateStatistics()
+        return;
+    }
+
+    // element at writePos left the window, the new one took its place
+    minQueue.evict(writePos);
+    maxQueue.evict(writePos);
+    minQueue.push(this->buffer.data(), writePos);
+    maxQueue.push(this->buffer.data(), writePos);
+
+    if(wraps)
+    {
+        // once per window, get rid of accumulated rounding errors
+        resyncRunning();
+        return;
+    }
+
+    updateRunning(el, evicted, evicting, this->maxCursor);
+}
+
+
+template <class T, uint32_t N>
+void StatisticBuffer<T, N>::updateRunning(const double x, const double old, const bool evicting, const uint32_t count)
+{
+    if(evicting)
+    {
+        // sliding window, replace evicted element with the new one
+        const double oldMean = runningMean;
+        runningMean += (x - old) / count;
+        runningM2 += (x - old) * (x - runningMean + old - oldMean);
+    }
+    else
+    {
+        // window is still growing
+        const double delta = x - runningMean;
+        runningMean += delta / count;
+        runningM2 += delta * (x - runningMean);
+    }
+}
+
+
+template <class T, uint32_t N>
+void StatisticBuffer<T, N>::insertMany(const T* src, size_t n)
+{
+    const uint32_t cap = this->capacity();
+
+    if(!runningValid || n >= cap)
+    {
+        // block replaces the whole window, rebuild from scratch in updateStatistics()
+        RingBuffer<T, N>::insertMany(src, n);
+        runningValid = false;
+        return;
+    }
+
+    const uint32_t start = this->writePos();
+    bool wraps = false;
+
+    // old elements are still in place, slide running sums over the whole block
+    for(uint32_t i=0; i<n; i++)
+    {
+        uint32_t pos = start + i;
+        if(pos >= cap) pos -= cap;
+
+        const uint32_t count = this->maxCursor + i;
+        const bool evicting = count >= cap;
+        wraps = wraps || (evicting && pos == 0);
+
+        updateRunning(src[i], this->buffer[pos], evicting, evicting ? cap : count + 1);
+    }
+
+    RingBuffer<T, N>::insertMany(src, n);
+
+    // overwritten elements are the oldest ones, drop all of them before comparing new ones
+    for(uint32_t i=0; i<n; i++)
+    {
+        uint32_t pos = start + i;
+        if(pos >= cap) pos -= cap;
+
+        minQueue.evict(pos);
+        maxQueue.evict(pos);
+    }
+
+    for(uint32_t i=0; i<n; i++)
+    {
+        uint32_t pos = start + i;
+        if(pos >= cap) pos -= cap;
+
+        minQueue.push(this->buffer.data(), pos);
+        maxQueue.push(this->buffer.data(), pos);
+    }
+
+    if(wraps)
+    {
+        // once per window, get rid of accumulated rounding errors
+        resyncRunning();
+    }
+}
+
+
+template <class T, uint32_t N>
+void StatisticBuffer<T, N>::resyncRunning()
+{
+    double sumOfElements {0};
+    double sumOfSquaredErrors {0};
+
+    for(uint32_t i=0; i<this->maxCursor; i++)
+    {
+        sumOfElements += this->buffer[i];
+    }
+
+    runningMean = this->maxCursor ? sumOfElements / this->maxCursor : 0;
+
+    for(uint32_t i=0; i<this->maxCursor; i++)
+    {
+        const double err = this->buffer[i] - runningMean;
+        sumOfSquaredErrors += err * err;
+    }
+
+    runningM2 = sumOfSquaredErrors;
+}
+
+
+template <class T, uint32_t N>
+void StatisticBuffer<T, N>::rebuildExtrema()
+{
+    minQueue.clear();
+    maxQueue.clear();
+
+    // if the window is full, the oldest element is the next to be overwritten
+    const uint32_t oldest = this->maxCursor == this->capacity() ? this->writePos() : 0;
+
+    for(uint32_t i=0; i<this->maxCursor; i++)
+    {
+        uint32_t idx = oldest + i;
+        if(idx >= this->capacity()) idx -= this->capacity();
+
+        minQueue.push(this->buffer.data(), idx);
+        maxQueue.push(this->buffer.data(), idx);
+    }
+}
+
+
+template <class T, uint32_t N>
+void StatisticBuffer<T, N>::updateStatistics()
+{
+    if(!runningValid)
+    {
+        resyncRunning();
+        rebuildExtrema();
+        runningValid = true;
+    }
+
+    min = minQueue.empty() ? INFINITY : this->buffer[minQueue.front()];
+    max = maxQueue.empty() ? -INFINITY : this->buffer[maxQueue.front()];
+
+    // M2 can drop slightly below zero due to rounding
+    const double m2 = runningM2 > 0 ? runningM2 : 0;
+
+    mean = runningMean;
+    stdDev = sqrtf(m2 / this->maxCursor);
+}
+
+
+template <class T, uint32_t N>
+void StatisticBuffer<T, N>::recalculateStatistics()
 {
     mean = 0;
     min = INFINITY;
@@ -47,7 +323,7 @@ void StatisticBuffer<T>::updateStatistics()
     double sumOfElements {0};
     double sumOfSquaredErrors {0};
 
-    for(int i=0; i<this->maxCursor; i++)
+    for(uint32_t i=0; i<this->maxCursor; i++)
     {
         T el = this->buffer[i];
         sumOfElements += el;
@@ -65,7 +341,7 @@ void StatisticBuffer<T>::updateStatistics()
 
     mean = sumOfElements / this->maxCursor;
 
-    for(int i=0; i<this->maxCursor; i++)
+    for(uint32_t i=0; i<this->maxCursor; i++)
     {
         sumOfSquaredErrors += powf(this->buffer[i] - mean, 2);
     }
@@ -74,29 +350,29 @@ void StatisticBuffer<T>::updateStatistics()
 }
 
 
-template <class T>
-const float & StatisticBuffer<T>::getStdDev()
+template <class T, uint32_t N>
+const float & StatisticBuffer<T, N>::getStdDev()
 {
     return stdDev;
 }
 
 
-template <class T>
-const float & StatisticBuffer<T>::getMean()
+template <class T, uint32_t N>
+const float & StatisticBuffer<T, N>::getMean()
 {
     return mean;
 }
 
 
-template <class T>
-const float & StatisticBuffer<T>::getMin()
+template <class T, uint32_t N>
+const float & StatisticBuffer<T, N>::getMin()
 {
     return this->min;
 }
 
 
-template <class T>
-const float & StatisticBuffer<T>::getMax()
+template <class T, uint32_t N>
+const float & StatisticBuffer<T, N>::getMax()
 {
     return max;
 }
@@ -0,0 +1,358 @@
+#ifndef TIERED_STATISTICS_HPP
+#define TIERED_STATISTICS_HPP
+
+#include <array>
+#include <cstdint>
+#include <cmath>
+#include <type_traits>
+
+namespace Xerxes
+{
+
+
+/**
+ * @brief Summary of a block of samples, can be merged with other summaries
+ *
+ * Keeps mean and sum of squared deviations from the mean (M2) instead of raw
+ * sums, so the variance of a channel with a large offset does not cancel out.
+ *
+ * @tparam T - type of the samples
+ */
+template <class T>
+struct BlockSummary
+{
+    uint32_t count {0};
+    double mean {0};
+    /// @brief sum of squared deviations from the mean
+    double m2 {0};
+    T min {};
+    T max {};
+
+    /// @brief add all samples summarized by other block, Chan's parallel combination
+    void merge(const BlockSummary &other);
+
+    /// @brief remove all samples
+    void clear();
+};
+
+
+/**
+ * @brief Accumulator of the samples of the open block of the first tier
+ *
+ * Sums deviations from the first sample of the block, exactly for integer
+ * samples, so the per sample work stays additions and one multiplication.
+ *
+ * @tparam T - type of the samples
+ */
+template <class T>
+struct BlockAccumulator
+{
+    /// @brief integer samples are summed exactly, floating point in double
+    typedef std::conditional_t<std::is_integral_v<T>, int64_t, double> acc_t;
+
+    uint32_t count {0};
+    /// @brief first sample of the block, sums are relative to it
+    T first {};
+    acc_t sum {0};
+    acc_t sumSq {0};
+    T min {};
+    T max {};
+
+    /// @brief add one sample to the block
+    void add(const T x);
+
+    /// @brief summary of the samples added since clear()
+    BlockSummary<T> summary() const;
+
+    /// @brief remove all samples
+    void clear();
+};
+
+
+/**
+ * @brief Statistics over several window lengths, kept as tiers of block summaries
+ *
+ * Samples are accumulated into an open block of the first tier. When the block
+ * is complete it is stored in the ring of BLOCKS completed blocks of its tier
+ * and merged into the open block of the next tier, and so on. The window of a
+ * tier is thus BLOCKS times its block length and slides by one block. Memory
+ * use is O(TIERS x BLOCKS) summaries, independent of the number of samples.
+ *
+ * Block length of the first tier is given in samples, block length of the
+ * other tiers in blocks of the previous tier. First tier block length 0 means
+ * its blocks are delimited by the caller with closeBlock(), eg. by time.
+ *
+ * @note integer samples: count * (x - first)^2 must fit into 63 bits for the longest
+ * first tier block, where first is the first sample of the block.
+ *
+ * @tparam CH - number of channels, at most 8 (one bit of the channel mask each)
+ * @tparam T - type of the samples
+ * @tparam TIERS - number of tiers (window lengths)
+ * @tparam BLOCKS - number of completed blocks kept in each tier
+ */
+template <uint8_t CH, class T, uint8_t TIERS, uint8_t BLOCKS>
+class TieredStatistics
+{
+    static_assert(CH > 0 && CH <= 8, "TieredStatistics supports 1 to 8 channels");
+    static_assert(TIERS > 0 && BLOCKS > 0, "TieredStatistics needs at least one tier and block");
+
+private:
+    typedef std::array<BlockSummary<T>, CH> row_t;
+
+    /// @brief samples of the open block of the first tier
+    std::array<BlockAccumulator<T>, CH> samples {};
+    /// @brief block being filled, per tier, first tier is summarized from samples when closed
+    std::array<row_t, TIERS> open {};
+    /// @brief ring of completed blocks, per tier
+    std::array<std::array<row_t, BLOCKS>, TIERS> blocks {};
+    /// @brief next block in the ring to be overwritten, per tier
+    std::array<uint8_t, TIERS> head {};
+    /// @brief number of completed blocks in the ring, per tier
+    std::array<uint8_t, TIERS> filled {};
+
+    /// @brief inputs (samples or blocks of previous tier) per block, per tier
+    std::array<uint32_t, TIERS> blockLen {};
+    /// @brief inputs merged into the open block, per tier
+    std::array<uint32_t, TIERS> inputs {};
+
+    /// @brief store open block of the tier and roll it up into the next tier
+    void close(uint8_t tier);
+
+public:
+    /**
+     * @brief Construct a new Tiered Statistics object
+     *
+     * @param blockLen block length of each tier, first in samples (0 = closeBlock() only), others in blocks of previous tier
+     */
+    TieredStatistics(const std::array<uint32_t, TIERS> &blockLen);
+
+    /**
+     * @brief Set block length of the tier, takes effect from the next block
+     *
+     * @param tier index of the tier
+     * @param len block length, first tier in samples, others in blocks of previous tier
+     */
+    void setBlockLength(const uint8_t tier, const uint32_t len);
+
+    /**
+     * @brief Insert one sample per channel
+     *
+     * @param values CH samples, one per channel
+     */
+    void insert(const T* values);
+
+    /// @brief Complete the open block of the first tier now, even if it is empty
+    void closeBlock();
+
+    /**
+     * @brief Write statistics of the tier window to the output arrays
+     *
+     * Arrays are indexed by channel, entries of channels outside the mask are
+     * left untouched. Nothing is written until the first block of the tier
+     * is completed. min and max may be nullptr if not needed.
+     *
+     * @param tier index of the tier
+     * @param mean mean of each channel
+     * @param stdDev standard deviation of each channel
+     * @param min minimum of each channel
+     * @param max maximum of each channel
+     * @param mask channels to publish, bit n = channel n
+     * @param scale conversion factor from samples to published unit
+     */
+    void publish(const uint8_t tier, float* mean, float* stdDev, float* min, float* max, const uint8_t mask, const float scale = 1.0f) const;
+};
+
+
+template <class T>
+void BlockSummary<T>::merge(const BlockSummary &other)
+{
+    if(other.count == 0)
+    {
+        return;
+    }
+
+    if(count == 0 || other.min < min) min = other.min;
+    if(count == 0 || other.max > max) max = other.max;
+
+    const double n = static_cast<double>(count) + other.count;
+    const double delta = other.mean - mean;
+
+    mean += delta * (other.count / n);
+    m2 += other.m2 + delta * delta * (count * (other.count / n));
+    count += other.count;
+}
+
+
+template <class T>
+void BlockSummary<T>::clear()
+{
+    count = 0;
+    mean = 0;
+    m2 = 0;
+}
+
+
+template <class T>
+void BlockAccumulator<T>::add(const T x)
+{
+    if(count == 0)
+    {
+        first = x;
+        min = x;
+        max = x;
+    }
+    if(x < min) min = x;
+    if(x > max) max = x;
+
+    const acc_t deviation = static_cast<acc_t>(x) - first;
+    count++;
+    sum += deviation;
+    sumSq += deviation * deviation;
+}
+
+
+template <class T>
+BlockSummary<T> BlockAccumulator<T>::summary() const
+{
+    BlockSummary<T> block;
+    if(count == 0)
+    {
+        return block;
+    }
+
+    const double n = count;
+    const double deviationMean = static_cast<double>(sum) / n;
+    const double m2 = static_cast<double>(sumSq) - static_cast<double>(sum) * deviationMean;
+
+    block.count = count;
+    block.mean = static_cast<double>(first) + deviationMean;
+    block.m2 = m2 > 0 ? m2 : 0;
+    block.min = min;
+    block.max = max;
+    return block;
+}
+
+
+template <class T>
+void BlockAccumulator<T>::clear()
+{
+    count = 0;
+    sum = 0;
+    sumSq = 0;
+}
+
+
+template <uint8_t CH, class T, uint8_t TIERS, uint8_t BLOCKS>
+TieredStatistics<CH, T, TIERS, BLOCKS>::TieredStatistics(const std::array<uint32_t, TIERS> &blockLen) :
+    blockLen(blockLen)
+{
+}
+
+
+template <uint8_t CH, class T, uint8_t TIERS, uint8_t BLOCKS>
+void TieredStatistics<CH, T, TIERS, BLOCKS>::setBlockLength(const uint8_t tier, const uint32_t len)
+{
+    blockLen[tier] = len;
+}
+
+
+template <uint8_t CH, class T, uint8_t TIERS, uint8_t BLOCKS>
+void TieredStatistics<CH, T, TIERS, BLOCKS>::insert(const T* values)
+{
+    for(uint8_t ch=0; ch<CH; ch++)
+    {
+        samples[ch].add(values[ch]);
+    }
+
+    if(++inputs[0] >= blockLen[0] && blockLen[0])
+    {
+        close(0);
+    }
+}
+
+
+template <uint8_t CH, class T, uint8_t TIERS, uint8_t BLOCKS>
+void TieredStatistics<CH, T, TIERS, BLOCKS>::closeBlock()
+{
+    close(0);
+}
+
+
+template <uint8_t CH, class T, uint8_t TIERS, uint8_t BLOCKS>
+void TieredStatistics<CH, T, TIERS, BLOCKS>::close(uint8_t tier)
+{
+    if(tier == 0)
+    {
+        for(uint8_t ch=0; ch<CH; ch++)
+        {
+            open[0][ch] = samples[ch].summary();
+            samples[ch].clear();
+        }
+    }
+
+    // completed block rolls up through the tiers as long as it completes their blocks too
+    while(true)
+    {
+        row_t &block = open[tier];
+        blocks[tier][head[tier]] = block;
+        head[tier] = head[tier] + 1 < BLOCKS ? head[tier] + 1 : 0;
+        filled[tier] += filled[tier] < BLOCKS;
+
+        const uint8_t next = tier + 1;
+        const bool rollUp = next < TIERS;
+        if(rollUp)
+        {
+            for(uint8_t ch=0; ch<CH; ch++)
+            {
+                open[next][ch].merge(block[ch]);
+            }
+        }
+
+        for(auto &summary : block)
+        {
+            summary.clear();
+        }
+        inputs[tier] = 0;
+
+        if(!rollUp || ++inputs[next] < blockLen[next])
+        {
+            return;
+        }
+        tier = next;
+    }
+}
+
+
+template <uint8_t CH, class T, uint8_t TIERS, uint8_t BLOCKS>
+void TieredStatistics<CH, T, TIERS, BLOCKS>::publish(const uint8_t tier, float* mean, float* stdDev, float* min, float* max, const uint8_t mask, const float scale) const
+{
+    for(uint8_t ch=0; ch<CH; ch++)
+    {
+        if(!(mask & (1 << ch)))
+        {
+            continue;
+        }
+
+        BlockSummary<T> window;
+        for(uint8_t i=0; i<filled[tier]; i++)
+        {
+            window.merge(blocks[tier][i][ch]);
+        }
+
+        if(window.count == 0)
+        {
+            continue;
+        }
+
+        mean[ch] = window.mean * scale;
+        stdDev[ch] = sqrt(window.m2 / window.count) * scale;
+
+        if(min) min[ch] = window.min * scale;
+        if(max) max[ch] = window.max * scale;
+    }
+}
+
+
+} // namespace Xerxes
+
+#endif // !TIERED_STATISTICS_HPP
@@ -1,27 +1,132 @@
 #include "Callbacks.hpp"
 
 
+#include <cstring>
 #include "Hardware/UserFlash.hpp"
 #include <xerxes-protocol/DeviceIds.h>
+#include "Communication/MessageIds.h"
 #include "Hardware/Sleep.hpp"
 #include "Hardware/InitUtils.hpp"
 #include "hardware/watchdog.h"
-#include "pico/multicore.h"
+#include "hardware/sync.h"
+#include "pico/mutex.h"
+#include "pico/time.h"
 #include "Core/Definitions.h"
 #include "Core/Slave.hpp"
 #include "Core/Register.hpp"
+#include "Communication/SlotTimer.hpp"
 #include "Sensors/all.hpp"
 
 
 extern Xerxes::Slave xs;
 extern Xerxes::Register _reg;
 extern Xerxes::__SENSOR_CLASS sensor;
+extern mutex_t regMutex;
+extern Xerxes::WriteRing writeFifo;
+extern Xerxes::SpscRing<uint64_t, PENDING_SYNCS_DEPTH> syncFifo;
+extern volatile bool commitRequested;
+extern volatile uint32_t baudSwitchTo;
+extern Xerxes::SlotTimer streamSlot;
+extern uint8_t streamMaster;
+bool commitNonVolatile();
 
 
 namespace Xerxes
 {
 
 
+/**
+ * @brief Check if the read range overlaps the registers derived from statistics
+ * 
+ * @param offset first byte of the read
+ * @param len number of bytes read
+ * @return true if mean, stddev, min, max, amplitude, long term statistics or quantile registers are read
+ */
+static bool readsStatistics(const uint16_t offset, const uint16_t len)
+{
+    // MEAN_PV0 .. QUANTILE2_PV3, other registers in between are read rarely enough not to bother
+    constexpr uint16_t begin = MEAN_PV0_OFFSET;
+    constexpr uint16_t end = QUANTILE2_PV3_OFFSET + sizeof(float);
+
+    return offset < end && offset + len > begin;
+}
+
+
+/**
+ * @brief Check if the read range overlaps the changed values bitmap
+ * 
+ * @param offset first byte of the read
+ * @param len number of bytes read
+ * @return true if changedMask is read and has to be cleared
+ */
+static bool readsChanges(const uint16_t offset, const uint16_t len)
+{
+    return offset <= CHANGED_MASK_OFFSET && offset + len > CHANGED_MASK_OFFSET;
+}
+
+
+/**
+ * @brief Check if the read range overlaps the latched alarm register
+ * 
+ * @param offset first byte of the read
+ * @param len number of bytes read
+ * @return true if alarm register is read and has to be acknowledged
+ */
+static bool readsAlarms(const uint16_t offset, const uint16_t len)
+{
+    return offset < ALARM_OFFSET + sizeof(uint64_t) && offset + len > ALARM_OFFSET;
+}
+
+
+/**
+ * @brief Copy from the published register, with the side effects of reading
+ * 
+ * Lazy statistics are brought up to date first, changedMask and alarm
+ * register are acknowledged after they were copied. Only these registers are
+ * published again, core1 may be in the middle of a sample meanwhile. The
+ * mutex is held by core1 just while it stamps and publishes a sample.
+ * 
+ * @tparam F callable as copy(const uint8_t* snapshot)
+ * @param statistics statistics registers are read
+ * @param changes changedMask is read
+ * @param alarms alarm register is read
+ * @param copy copies what it needs from the snapshot
+ */
+template <class F>
+static void readRegister(bool statistics, const bool changes, const bool alarms, F copy)
+{
+    statistics = statistics && _reg.config()->bits.lazyStat;
+
+    if(!statistics && !changes && !alarms)
+    {
+        _reg.readPublishedWith(copy);
+        return;
+    }
+
+    mutex_enter_blocking(&regMutex);
+
+    // statistics are calculated lazily, bring them up to date before reading
+    if(statistics)
+    {
+        sensor.publishStatistics();
+        _reg.publish(MEAN_PV0_OFFSET, DV0_OFFSET - MEAN_PV0_OFFSET);
+        _reg.publish(MEAN_10S_PV0_OFFSET, QUANTILE2_PV3_OFFSET + sizeof(float) - MEAN_10S_PV0_OFFSET);
+    }
+
+    _reg.readPublishedWith(copy);
+
+    // changes and alarms were reported, start over
+    if(changes || alarms)
+    {
+        _reg.acknowledge(changes, alarms);
+        _reg.publish(CHANGED_MASK_OFFSET, sizeof(uint8_t));
+        _reg.publish(ALARM_OFFSET, sizeof(uint64_t));
+    }
+
+    mutex_exit(&regMutex);
+}
+
+
 void pingCallback(const Xerxes::Message &msg)
 {
     uint8_t _devid = sensor.getDevid();
@@ -32,7 +137,37 @@ void pingCallback(const Xerxes::Message &msg)
 
 void syncCallback(const Xerxes::Message &msg)
 {   
-    sensor.update();
+    // time of the sync itself, core1 samples as soon as it is done with the current sample
+    const uint64_t captureTime = time_us_64();
+
+    // core1 is behind by several syncs already, skip this one
+    if(syncFifo.push(captureTime))
+    {
+        __sev();
+    }
+
+    // slots are counted from the moment this node received the sync
+    if(_reg.config()->bits.stream && msg.dstAddr == 0xff)
+    {
+        streamMaster = msg.srcAddr;
+        streamSlot.start(captureTime, *_reg.streamSlot(), *_reg.streamSlotLenUs(), *_reg.streamPeriodUs());
+    }
+}
+
+
+void sendStreamValue()
+{
+    // counter, process values and discrete values of the same cycle
+    std::vector<uint8_t> payload(sizeof(uint32_t) + 4 * sizeof(float) + 4 * sizeof(uint32_t));
+    _reg.readPublishedWith([&](const uint8_t* snapshot)
+    {
+        uint8_t* dst = payload.data();
+        std::memcpy(dst, snapshot + SAMPLE_COUNTER_OFFSET, sizeof(uint32_t));
+        std::memcpy(dst + 4, snapshot + PV0_OFFSET, 4 * sizeof(float));
+        std::memcpy(dst + 20, snapshot + DV0_OFFSET, 4 * sizeof(uint32_t));
+    });
+
+    xs.send(streamMaster, MSGID_STREAM_VALUE, payload);
 }
 
 
@@ -43,50 +178,33 @@ void writeRegCallback(const Xerxes::Message &msg)
     uint8_t offsetH = msg.at(5);
     // convert to uint16_t
     uint16_t offset = (offsetH << 8) + offsetL;
+    // number of bytes to write, data starts at byte 6
+    uint16_t len = msg.size() > 6 ? msg.size() - 6 : 0;
         
-    // check if offset is valid (not read only memory and not negative)
-    if(offset >= READ_ONLY_OFFSET || offset < 0)
+    // check if whole range is writable (inside register, no read only field)
+    if(!isWritable(offset, len) || len > REGISTER_WRITE_MAX_LEN)
     {
         // send ACK_NOK
         xs.send(msg.srcAddr, MSGID_ACK_NOK);
         return;
     }
 
-    // lock out core1, wait 10ms for core1 to lock out
-    if(!multicore_lockout_start_timeout_us(10'000))
-    {
-        // lockout failed, send ACK_NOK
-        xs.send(msg.srcAddr, MSGID_ACK_NOK);
-        return;
-    }
-
-    // disable interrupts
-    auto status = save_and_disable_interrupts();
-
-    // write data to memory
-    for(uint16_t i = 6; i < msg.size(); i++)
+    RegisterWrite write {offset, len, {}, msg.srcAddr};
+    for(uint16_t i = 0; i < len; i++)
     {
-        uint8_t byte = msg.at(i);
-        _reg.memTable[offset + i - 6] = byte;
+        write.data[i] = msg.at(i + 6);
     }
 
-    // restore interrupts
-    restore_interrupts(status);
-
-    // unlock core1, wait 10ms for core1 to unlock
-    multicore_lockout_end_timeout_us(10'000);
-    
-    // if memory written is in non-volatile range, update flash
-    if(offset < VOLATILE_OFFSET)
+    // core1 applies the write between samples, main loop sends ACK_OK once it is published
+    if(!writeFifo.push(write))
     {
-        // update flash, takes ~50ms to complete hence the 2 watchdog updates
-        watchdog_update();
-        updateFlash((uint8_t *)_reg.memTable);
-        watchdog_update();
+        // too many writes pending, send ACK_NOK
+        xs.send(msg.srcAddr, MSGID_ACK_NOK);
+        return;
     }
 
-    // send ACK_OK
-    xs.send(msg.srcAddr, MSGID_ACK_OK);
+    // wake core1 if it waits for the next cycle
+    __sev();
 }
 
 
@@ -108,14 +226,13 @@ void readRegCallback(const Xerxes::Message &msg)
         xs.send(msg.srcAddr, MSGID_ACK_NOK);
         return;
     }
-    
-    std::vector<uint8_t> payload {};
 
-    // read data from memory into payload vector
-    for(uint16_t i = offset; i < offset + len; i++)
+    // copy consistent snapshot of the last cycle into payload vector
+    std::vector<uint8_t> payload(len);
+    readRegister(readsStatistics(offset, len), readsChanges(offset, len), readsAlarms(offset, len), [&](const uint8_t* snapshot)
     {
-        payload.emplace_back(_reg.memTable[i]);
-    }
+        std::memcpy(payload.data(), snapshot + offset, len);
+    });
 
     // send data to master device (MSGID_READ_VALUE + payload) 
     xs.send(msg.srcAddr, MSGID_READ_VALUE, payload);
@@ -123,6 +240,115 @@ void readRegCallback(const Xerxes::Message &msg)
 }
 
 
+void readMultiCallback(const Xerxes::Message &msg)
+{
+    // ranges start at byte 4, 2 bytes of offset in little endian and 1 byte of length each
+    constexpr uint16_t rangeSize = 3;
+    const uint16_t rangesLen = msg.size() > 4 ? msg.size() - 4 : 0;
+
+    if(rangesLen == 0 || rangesLen % rangeSize)
+    {
+        xs.send(msg.srcAddr, MSGID_ACK_NOK);
+        return;
+    }
+
+    std::vector<uint16_t> offsets {};
+    std::vector<uint8_t> lens {};
+    uint16_t total = 0;
+    bool statistics = false;
+    bool changes = false;
+    bool alarms = false;
+
+    for(uint16_t i = 4; i < msg.size(); i += rangeSize)
+    {
+        uint16_t offset = (msg.at(i + 1) << 8) + msg.at(i);
+        uint8_t len = msg.at(i + 2);
+
+        // same check as single read, plus the size of the reply
+        total += len;
+        if(offset + len > REGISTER_SIZE || total > READ_MULTI_MAX_LEN)
+        {
+            xs.send(msg.srcAddr, MSGID_ACK_NOK);
+            return;
+        }
+
+        statistics |= readsStatistics(offset, len);
+        changes |= readsChanges(offset, len);
+        alarms |= readsAlarms(offset, len);
+        offsets.emplace_back(offset);
+        lens.emplace_back(len);
+    }
+
+    // copy all ranges from one snapshot, so they belong to the same cycle
+    std::vector<uint8_t> payload(total);
+    readRegister(statistics, changes, alarms, [&](const uint8_t* snapshot)
+    {
+        uint8_t* dst = payload.data();
+        for(size_t i = 0; i < offsets.size(); i++)
+        {
+            std::memcpy(dst, snapshot + offsets[i], lens[i]);
+            dst += lens[i];
+        }
+    });
+
+    xs.send(msg.srcAddr, MSGID_READ_VALUE, payload);
+}
+
+
+void pollChangesCallback(const Xerxes::Message &msg)
+{
+    // bitmap followed by the values of set bits, pv0-3 then dv0-3, 4 bytes each
+    std::vector<uint8_t> payload {};
+    readRegister(false, true, false, [&](const uint8_t* snapshot)
+    {
+        const uint8_t changed = snapshot[CHANGED_MASK_OFFSET];
+
+        payload.clear();
+        payload.emplace_back(changed);
+
+        for(uint8_t i = 0; i < 8; i++)
+        {
+            if(!(changed & (1 << i)))
+            {
+                continue;
+            }
+
+            const uint16_t offset = i < 4 ? PV0_OFFSET + 4 * i : DV0_OFFSET + 4 * (i - 4);
+            payload.insert(payload.end(), snapshot + offset, snapshot + offset + 4);
+        }
+    });
+
+    xs.send(msg.srcAddr, MSGID_READ_VALUE, payload);
+}
+
+
+void commitCallback(const Xerxes::Message &msg)
+{
+    // main loop commits once the bus is idle, after this ACK is sent
+    commitRequested = true;
+    xs.send(msg.srcAddr, MSGID_ACK_OK);
+}
+
+
+void baudSwitchCallback([[maybe_unused]] const Xerxes::Message &msg)
+{
+    // writes are applied before their ACK, so the register holds the rate the master staged
+    // main loop switches once the transmitter is idle, a reply in flight must not be cut
+    baudSwitchTo = userBaudrate();
+}
+
+
+/// @brief store non-volatile registers now instead of after the commit delay
+static void commitPending()
+{
+    // core1 may be slow to park, give it a few attempts
+    for(uint8_t i = 0; i < 3 && !commitNonVolatile(); i++)
+    {
+        watchdog_update();
+    }
+}
+
+
 void sleepCallback(const Xerxes::Message &msg)
 {
     uint8_t raw_duration[4];
@@ -135,12 +361,16 @@ void sleepCallback(const Xerxes::Message &msg)
     uint32_t *durationUs = (uint32_t *)raw_duration;
     uint64_t cleanUs = static_cast<uint64_t>(*durationUs);
     
+    // main loop is not running while asleep, store pending writes now
+    commitPending();
     sleep_lp(cleanUs);
 }
 
 
-void softResetCallback(const Xerxes::Message &msg)
+void softResetCallback([[maybe_unused]] const Xerxes::Message &msg)
 {
+    // writes still waiting for the commit delay would be lost by the reboot
+    commitPending();
     watchdog_reboot(0,0,0);
 }
 
@@ -149,7 +379,7 @@ void factoryResetCallback(const Xerxes::Message &msg)
 {   
     /** @brief 0x55AA55AA = unlocked, anything else = locked */
     // check if memory is unlocked (factory reset is allowed only if memory is unlocked)
-    if(*_reg.memUnlocked == MEM_UNLOCKED_VAL)
+    if(*_reg.memUnlocked() == MEM_UNLOCKED_VAL)
     {
         // reset memory
         userLoadDefaultValues();
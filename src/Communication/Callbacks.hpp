@@ -27,18 +27,31 @@ void pingCallback(const Xerxes::Message &msg);
  * 
  * @param msg incoming message
  * 
- * @note This function does not return an answer, it only polls the sensor
+ * @note This function does not return an answer, core1 takes the sample as
+ * soon as it is done with the current one, stamped with the time of the sync.
+ * In stream mode a broadcast sync also starts the time slots of this node.
  */
 void syncCallback(const Xerxes::Message &msg);
 
 
+/**
+ * @brief Send the last sample to the master of the stream
+ * 
+ * Sent as <MSGID_STREAM_VALUE> <sampleCounter> <pv0-3> <dv0-3>, all from the
+ * same cycle, when the time slot of this node starts.
+ */
+void sendStreamValue();
+
+
 /**
  * @brief Write register callback
  * 
  * Write <LEN> bytes of <DATA> to the device register, starting at <REG_ID>
  * The request prototype is <MSGID_WRITE> <REG_ID> <LEN> <DATA>
  * 
- * @note This function is blocking, it will not return until the data is written to the register
+ * @note The write is queued for core1, which applies and publishes it between
+ * samples. ACK_OK is sent by the main loop afterwards, so a read after it sees
+ * the new value. Non-volatile range is stored to flash after the commit delay.
  * 
  * @param msg 
  */
@@ -53,16 +66,75 @@ void writeRegCallback(const Xerxes::Message &msg);
  * 
  * @param msg 
  * 
- * @note This function is blocking, it will not return until the data is read from the register
- * and sent to the master device.
+ * @note Data are read from the snapshot published at the end of the last cycle,
+ * so all values belong to the same cycle.
  * @note All data are in little endian format - LSB first. 
  */
 void readRegCallback(const Xerxes::Message &msg);
 
 
+/**
+ * @brief Multi-range read register callback
+ * 
+ * Read several ranges of the device register and reply with them concatenated
+ * in the order requested, all from the same cycle.
+ * The request prototype is <MSGID_READ_MULTI> (<REG_ID> <LEN>)...
+ * 
+ * @param msg 
+ * 
+ * @note ACK_NOK is sent if any range exceeds the register or the reply would exceed READ_MULTI_MAX_LEN.
+ */
+void readMultiCallback(const Xerxes::Message &msg);
+
+
+/**
+ * @brief Poll changes callback
+ * 
+ * Reply with changedMask followed by the values of the set bits in bit order,
+ * pv0-3 as float and dv0-3 as uint32, then clear changedMask.
+ * The request prototype is <MSGID_POLL_CHANGES>
+ * 
+ * @param msg 
+ */
+void pollChangesCallback(const Xerxes::Message &msg);
+
+
+/**
+ * @brief Commit callback
+ * 
+ * Store non-volatile registers to flash as soon as the bus is idle, without
+ * waiting for the commit delay. The request prototype is <MSGID_COMMIT>
+ * 
+ * @param msg 
+ * 
+ * @note ACK_OK is sent right away, flash is written only if its content differs.
+ */
+void commitCallback(const Xerxes::Message &msg);
+
+
+/**
+ * @brief Baud switch callback
+ * 
+ * Switch the link to the baud rate register, as it is when the request
+ * arrives, once the replies already queued are sent. Any valid frame on the
+ * bus confirms the new rate, also one for another node. If none arrives within
+ * the baud fallback register afterwards, the link falls back to
+ * DEFAULT_BAUDRATE and keeps alternating between both rates until one is
+ * confirmed.
+ * The request prototype is <MSGID_BAUD_SWITCH>, usually broadcast.
+ * 
+ * @param msg 
+ * 
+ * @note Nothing is sent back, write and commit the baud rate register first.
+ */
+void baudSwitchCallback(const Xerxes::Message &msg);
+
+
 /**
  * @brief Attempt to perform low power sleep
  * 
+ * Pending changes of non-volatile registers are committed before sleeping.
+ * 
  * @param msg incoming message
  */
 void sleepCallback(const Xerxes::Message &msg);
@@ -71,6 +143,8 @@ void sleepCallback(const Xerxes::Message &msg);
 /**
  * @brief Attempt to perform soft reset
  * 
+ * Pending changes of non-volatile registers are committed before rebooting.
+ * 
  * @param msg
  * 
  * @note This function does not return
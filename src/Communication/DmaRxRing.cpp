@@ -0,0 +1,147 @@
+#include "DmaRxRing.hpp"
+
+
+#include "hardware/dma.h"
+#include "hardware/sync.h"
+
+
+namespace Xerxes
+{
+
+
+void DmaRxRing::start(uart_inst_t *uart)
+{
+    channel = dma_claim_unused_channel(true);
+
+    dma_channel_config config = dma_channel_get_default_config(channel);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_8);
+    channel_config_set_read_increment(&config, false);
+    channel_config_set_write_increment(&config, true);
+    // wrap write address within the ring
+    channel_config_set_ring(&config, true, SIZE_BITS);
+    // transfer a byte whenever the UART has received one
+    channel_config_set_dreq(&config, uart_get_dreq(uart, false));
+
+    runStart = 0;
+    readPos = 0;
+    sampledCount = RUN_LEN;
+    arrivalUs = time_us_32();
+    dma_channel_configure(channel, &config, ring, &uart_get_hw(uart)->dr, RUN_LEN, true);
+
+    // negative period keeps the samples evenly spaced regardless of callback duration
+    add_repeating_timer_us(-ARRIVAL_SAMPLE_US, sampleArrival, this, &arrivalTimer);
+}
+
+
+bool DmaRxRing::sampleArrival(repeating_timer_t *timer)
+{
+    DmaRxRing *self = static_cast<DmaRxRing *>(timer->user_data);
+    const uint32_t count = dma_channel_hw_addr(self->channel)->transfer_count;
+
+    if(count != self->sampledCount)
+    {
+        self->sampledCount = count;
+        self->arrivalUs = time_us_32();
+    }
+
+    return true;
+}
+
+
+uint32_t DmaRxRing::writePos()
+{
+    if(channel < 0)
+    {
+        return readPos;
+    }
+
+    const uint32_t remaining = dma_channel_hw_addr(channel)->transfer_count;
+
+    // run is over after 4G bytes, restart it, write address continues where it stopped
+    if(remaining == 0 && !dma_channel_is_busy(channel))
+    {
+        runStart += RUN_LEN;
+        dma_channel_set_trans_count(channel, RUN_LEN, true);
+        return runStart;
+    }
+
+    return runStart + (RUN_LEN - remaining);
+}
+
+
+uint32_t DmaRxRing::available()
+{
+    const uint32_t pos = writePos();
+
+    // DMA overwrote bytes which were not read yet, drop everything
+    if(pos - readPos > SIZE)
+    {
+        readPos = pos;
+        overrunFlag = true;
+    }
+
+    return pos - readPos;
+}
+
+
+uint32_t DmaRxRing::lastArrivalUs() const
+{
+    return arrivalUs;
+}
+
+
+bool DmaRxRing::pop(uint8_t &byte)
+{
+    return pop(&byte, 1) == 1;
+}
+
+
+uint32_t DmaRxRing::pop(uint8_t *dst, const uint32_t len)
+{
+    uint32_t count = available();
+    if(count > len)
+    {
+        count = len;
+    }
+
+    // bytes written by DMA before the transfer count was read must not be read earlier
+    __compiler_memory_barrier();
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+        dst[i] = ring[(readPos + i) & (SIZE - 1)];
+    }
+    readPos += count;
+
+    return count;
+}
+
+
+uint32_t DmaRxRing::skip(const uint32_t len)
+{
+    uint32_t count = available();
+    if(count > len)
+    {
+        count = len;
+    }
+
+    readPos += count;
+    return count;
+}
+
+
+void DmaRxRing::clear()
+{
+    readPos = writePos();
+}
+
+
+bool DmaRxRing::overrun()
+{
+    const bool flag = overrunFlag;
+    overrunFlag = false;
+    return flag;
+}
+
+
+} // namespace Xerxes
@@ -0,0 +1,128 @@
+#ifndef __DMA_RX_RING_HPP
+#define __DMA_RX_RING_HPP
+
+
+#include <cstdint>
+#include <cstddef>
+#include "hardware/uart.h"
+#include "pico/time.h"
+#include "Core/Definitions.h"
+
+
+namespace Xerxes
+{
+
+
+/**
+ * @brief UART receiver, DMA copies every received byte into a ring in SRAM
+ *
+ * The DMA channel is paced by the UART RX DREQ and wraps its write address
+ * within the ring, so receiving costs no CPU time and no interrupts. The
+ * reader derives the write position from the remaining transfer count of the
+ * channel, all positions are kept as free running byte counters.
+ *
+ * A repeating timer samples the transfer count every ARRIVAL_SAMPLE_US and
+ * notes when it moved, so the reader knows when bytes arrived on the line,
+ * not only when it took them from the ring.
+ *
+ * @note one reader only, methods are not safe to call from several cores.
+ */
+class DmaRxRing
+{
+public:
+    /// @brief log2 of the ring size, DMA ring wrap needs a power of two
+    static constexpr uint8_t SIZE_BITS = 10;
+    /// @brief ring size in bytes
+    static constexpr uint32_t SIZE = 1 << SIZE_BITS;
+
+private:
+    /// @brief DMA ring wrap requires the buffer to be aligned to its size
+    alignas(SIZE) uint8_t ring[SIZE];
+
+    /// @brief transfer count of one DMA run, channel is restarted when it runs out
+    static constexpr uint32_t RUN_LEN = 0xFFFFFFFF;
+    /// @brief period of sampling the transfer count, a quarter of the shortest frame gap
+    static constexpr int64_t ARRIVAL_SAMPLE_US = FRAME_GAP_US / 4;
+
+    /// @brief DMA channel, -1 if not started
+    int channel {-1};
+    /// @brief bytes received before the current DMA run
+    uint32_t runStart {0};
+    /// @brief bytes consumed by the reader
+    uint32_t readPos {0};
+    /// @brief reader fell more than SIZE bytes behind, bytes were lost
+    bool overrunFlag {false};
+
+    /// @brief timer sampling the transfer count
+    repeating_timer_t arrivalTimer {};
+    /// @brief transfer count seen by the last sample
+    volatile uint32_t sampledCount {0};
+    /// @brief time_us_32() of the first sample which saw the transfer count move
+    volatile uint32_t arrivalUs {0};
+
+    /// @brief number of bytes received so far, restarts the DMA run if it ran out
+    uint32_t writePos();
+
+    /// @brief timer callback, notes the time if bytes arrived since the previous sample
+    static bool sampleArrival(repeating_timer_t *timer);
+
+public:
+    /**
+     * @brief Claim a DMA channel and start receiving from the UART
+     *
+     * @param uart initialized UART instance
+     */
+    void start(uart_inst_t *uart);
+
+    /// @brief Number of bytes ready to be read
+    uint32_t available();
+
+    /**
+     * @brief Time the last byte arrived on the line
+     *
+     * @return uint32_t time_us_32() at most ARRIVAL_SAMPLE_US after the byte arrived
+     */
+    uint32_t lastArrivalUs() const;
+
+    /**
+     * @brief Read one byte
+     *
+     * @param byte received byte
+     * @return true if a byte was read
+     * @return false if the ring is empty
+     */
+    bool pop(uint8_t &byte);
+
+    /**
+     * @brief Read up to len bytes
+     *
+     * @param dst destination, at least len bytes
+     * @param len maximum number of bytes to read
+     * @return uint32_t number of bytes read
+     */
+    uint32_t pop(uint8_t *dst, const uint32_t len);
+
+    /**
+     * @brief Drop up to len bytes without copying them
+     *
+     * @param len maximum number of bytes to drop
+     * @return uint32_t number of bytes dropped
+     */
+    uint32_t skip(const uint32_t len);
+
+    /// @brief Drop all received bytes
+    void clear();
+
+    /**
+     * @brief Check and clear the overrun flag
+     *
+     * @return true if bytes were lost since the last check
+     */
+    bool overrun();
+};
+
+
+} // namespace Xerxes
+
+
+#endif // !__DMA_RX_RING_HPP
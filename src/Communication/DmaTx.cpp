@@ -0,0 +1,75 @@
+#include "DmaTx.hpp"
+
+
+#include "hardware/dma.h"
+#include "hardware/gpio.h"
+#include "Hardware/Board/xerxes_rp2040.h"
+
+
+namespace Xerxes
+{
+
+
+void DmaTx::start(uart_inst_t *uart)
+{
+    this->uart = uart;
+    channel = dma_claim_unused_channel(true);
+
+    dma_channel_config config = dma_channel_get_default_config(channel);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_8);
+    channel_config_set_read_increment(&config, true);
+    channel_config_set_write_increment(&config, false);
+    // transfer a byte whenever the UART has room for one
+    channel_config_set_dreq(&config, uart_get_dreq(uart, true));
+
+    dma_channel_configure(channel, &config, &uart_get_hw(uart)->dr, buffer, 0, false);
+}
+
+
+bool DmaTx::idle()
+{
+    if(!active)
+    {
+        return true;
+    }
+
+    // DMA done is not enough, the UART still shifts out bytes from its fifo
+    if(dma_channel_is_busy(channel) || (uart_get_hw(uart)->fr & UART_UARTFR_BUSY_BITS))
+    {
+        return false;
+    }
+
+    #ifdef RS_DE_PIN
+    // last stop bit is out, release the bus
+    gpio_put(RS_DE_PIN, 0);
+    #endif // RS_DE_PIN
+
+    active = false;
+    return true;
+}
+
+
+uint8_t *DmaTx::data()
+{
+    return buffer;
+}
+
+
+bool DmaTx::send(const uint32_t len)
+{
+    if(channel < 0 || !idle() || len == 0 || len > SIZE)
+    {
+        return false;
+    }
+
+    #ifdef RS_DE_PIN
+    gpio_put(RS_DE_PIN, 1);
+    #endif // RS_DE_PIN
+
+    active = true;
+    dma_channel_transfer_from_buffer_now(channel, buffer, len);
+    return true;
+}
+
+
+} // namespace Xerxes
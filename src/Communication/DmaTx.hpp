@@ -0,0 +1,79 @@
+#ifndef __DMA_TX_HPP
+#define __DMA_TX_HPP
+
+
+#include <cstdint>
+#include "hardware/uart.h"
+#include "Core/Definitions.h"
+
+
+namespace Xerxes
+{
+
+
+/**
+ * @brief Non-blocking UART transmitter, DMA feeds the frame to the UART
+ *
+ * The frame is copied into the transmitter buffer and handed over to a DMA
+ * channel paced by the UART TX DREQ, the caller returns immediately. The
+ * transmission is complete only when the DMA has finished and the UART has
+ * shifted out the last stop bit, only then the bus is turned around.
+ *
+ * Boards with an automatic direction transceiver (MAX13487E on xerxes_rp2040)
+ * need no turnaround. Boards which define RS_DE_PIN drive the transceiver
+ * driver enable with it, high while transmitting.
+ */
+class DmaTx
+{
+public:
+    /// @brief maximum frame length
+    static constexpr uint32_t SIZE = RX_TX_QUEUE_SIZE;
+
+private:
+    uint8_t buffer[SIZE];
+
+    uart_inst_t *uart {nullptr};
+    /// @brief DMA channel, -1 if not started
+    int channel {-1};
+    /// @brief frame was handed to DMA and its completion was not reported yet
+    bool active {false};
+
+public:
+    /**
+     * @brief Claim a DMA channel for the UART
+     *
+     * @param uart initialized UART instance
+     */
+    void start(uart_inst_t *uart);
+
+    /**
+     * @brief Check if the transmitter is free, report completion of the last frame
+     *
+     * Turns the bus around when the last frame has left the UART.
+     *
+     * @return true if a new frame can be sent
+     */
+    bool idle();
+
+    /**
+     * @brief Buffer to fill with the next frame, valid only while idle
+     *
+     * @return uint8_t* SIZE bytes
+     */
+    uint8_t *data();
+
+    /**
+     * @brief Start sending len bytes of the buffer
+     *
+     * @param len number of bytes in the buffer
+     * @return true if transmission started
+     * @return false if the transmitter is busy
+     */
+    bool send(const uint32_t len);
+};
+
+
+} // namespace Xerxes
+
+
+#endif // !__DMA_TX_HPP
@@ -0,0 +1,336 @@
+#ifndef __FRAME_PARSER_HPP
+#define __FRAME_PARSER_HPP
+
+
+#include <cstdint>
+#include <span>
+
+
+namespace Xerxes
+{
+
+
+/**
+ * @brief Resumable parser of Xerxes frames, <SOH> <LEN> <BODY> <CHKS>
+ *
+ * Bytes are fed in whatever pieces they arrive, the parser keeps its state
+ * between calls so no byte is lost when a frame is split. The body is
+ * collected into a fixed buffer and is available once the checksum verified.
+ * LEN counts the whole frame including SOH, LEN and CHKS, all bytes of a
+ * valid frame sum up to 0.
+ *
+ * If an address is given, the destination byte is checked as soon as it
+ * arrives. Frames for other nodes are skipped by their length without being
+ * stored, only broadcast and own frames complete. Their checksum is verified
+ * only if the skipped bytes are parsed, skip() drops them unseen.
+ */
+class FrameParser
+{
+public:
+    /// @brief start of frame, same as Xerxes::SOH
+    static constexpr uint8_t SOH = 0x01;
+    /// @brief SOH, LEN and CHKS
+    static constexpr uint8_t OVERHEAD = 3;
+    /// @brief shortest body, source, destination and 2 bytes of message id
+    static constexpr uint8_t MIN_BODY = 4;
+    /// @brief longest body, LEN is one byte
+    static constexpr uint32_t MAX_BODY = 0xFF - OVERHEAD;
+    /// @brief position of the destination address in the body
+    static constexpr uint8_t DST_INDEX = 1;
+    /// @brief destination address of frames for all nodes
+    static constexpr uint8_t BROADCAST = 0xFF;
+
+private:
+    enum class State : uint8_t
+    {
+        SOH,
+        LEN,
+        BODY,
+        CHECKSUM,
+        SKIP,
+        COMPLETE,
+    };
+
+    State state {State::SOH};
+    /// @brief running sum of the frame bytes
+    uint8_t chks {0};
+    /// @brief body length announced by LEN
+    uint32_t bodyLen {0};
+    /// @brief body bytes received so far
+    uint32_t received {0};
+    /// @brief bytes of a frame for another node still to skip, including CHKS
+    uint32_t skipLeft {0};
+    /// @brief frames dropped because of a bad length or checksum
+    uint32_t errorCount {0};
+    /// @brief frames with a valid checksum, complete or verified while skipped
+    uint32_t validCount {0};
+    /// @brief all bytes of the frame being skipped were parsed so far
+    bool verifying {false};
+    /// @brief own address, nullptr to accept frames for any node
+    const uint8_t *address {nullptr};
+    uint8_t body[MAX_BODY];
+
+    /// @brief drop the current frame and wait for SOH
+    void restart();
+
+    /// @brief true if a frame for this destination is to be received
+    bool accepts(const uint8_t dst) const;
+
+    /// @brief drop count bytes of the frame being skipped, check it once it ends
+    void skipped(const uint32_t count);
+
+public:
+    FrameParser() = default;
+
+    /**
+     * @brief Construct a parser which completes only frames for this node
+     *
+     * @param ownAddress own address, read for every frame so it may change at runtime
+     */
+    explicit FrameParser(const uint8_t *ownAddress);
+
+    /**
+     * @brief Consume bytes until a frame is complete
+     *
+     * @param src received bytes
+     * @return uint32_t number of bytes consumed, less than src.size() only if a frame completed
+     */
+    uint32_t parse(std::span<const uint8_t> src);
+
+    /**
+     * @brief Number of bytes which can be consumed without passing the end of the current frame
+     *
+     * @return uint32_t at least 1
+     */
+    uint32_t needed() const;
+
+    /// @brief true if a frame with valid checksum is ready, until more bytes are parsed
+    bool complete() const;
+
+    /// @brief true if part of a frame was received
+    bool receiving() const;
+
+    /// @brief true if the rest of a frame for another node is being skipped, see needed()
+    bool skipping() const;
+
+    /**
+     * @brief Skip bytes of a frame for another node without looking at them
+     *
+     * The checksum of the frame is not verified then, see valid().
+     *
+     * @param count number of bytes, at most needed()
+     */
+    void skip(const uint32_t count);
+
+    /// @brief body of the complete frame, <SRC> <DST> <MSGID> <PAYLOAD>
+    std::span<const uint8_t> frame() const;
+
+    /// @brief number of frames dropped because of a bad length or checksum
+    uint32_t errors() const;
+
+    /// @brief number of frames with a valid checksum, including frames for other nodes whose bytes were all parsed
+    uint32_t valid() const;
+
+    /// @brief drop the frame being received
+    void reset();
+};
+
+
+inline void FrameParser::restart()
+{
+    errorCount++;
+    state = State::SOH;
+}
+
+
+inline FrameParser::FrameParser(const uint8_t *ownAddress) : address(ownAddress)
+{
+}
+
+
+inline bool FrameParser::accepts(const uint8_t dst) const
+{
+    return address == nullptr || dst == BROADCAST || dst == *address;
+}
+
+
+inline uint32_t FrameParser::parse(std::span<const uint8_t> src)
+{
+    uint32_t i = 0;
+
+    // previous frame was taken, start a new one
+    if(state == State::COMPLETE && !src.empty())
+    {
+        state = State::SOH;
+    }
+
+    while(i < src.size() && state != State::COMPLETE)
+    {
+        switch(state)
+        {
+        case State::SOH:
+            // skip anything between frames
+            if(src[i] == SOH)
+            {
+                chks = SOH;
+                state = State::LEN;
+            }
+            i++;
+            break;
+
+        case State::LEN:
+            if(src[i] < OVERHEAD + MIN_BODY)
+            {
+                // length can not be right, wait for the next SOH, this byte may be it
+                restart();
+                break;
+            }
+            chks += src[i];
+            bodyLen = src[i] - OVERHEAD;
+            received = 0;
+            state = State::BODY;
+            i++;
+            break;
+
+        case State::BODY:
+        {
+            // copy as much of the body as is available at once, stop at the destination to check it first
+            const uint32_t until = received <= DST_INDEX ? DST_INDEX + 1 : bodyLen;
+            while(i < src.size() && received < until)
+            {
+                body[received++] = src[i];
+                chks += src[i++];
+            }
+            if(received == DST_INDEX + 1 && !accepts(body[DST_INDEX]))
+            {
+                // not for us, the rest of the body and CHKS are not stored
+                skipLeft = bodyLen - received + 1;
+                verifying = true;
+                state = State::SKIP;
+            }
+            else if(received == bodyLen)
+            {
+                state = State::CHECKSUM;
+            }
+            break;
+        }
+
+        case State::CHECKSUM:
+            chks += src[i++];
+            if(chks == 0)
+            {
+                validCount++;
+                state = State::COMPLETE;
+            }
+            else
+            {
+                restart();
+            }
+            break;
+
+        case State::SKIP:
+        {
+            // frame is not stored, its bytes are only summed to verify the checksum
+            const uint32_t count = src.size() - i < skipLeft ? src.size() - i : skipLeft;
+            for(uint32_t j = 0; j < count; j++)
+            {
+                chks += src[i++];
+            }
+            skipped(count);
+            break;
+        }
+
+        case State::COMPLETE:
+            break;
+        }
+    }
+
+    return i;
+}
+
+
+inline uint32_t FrameParser::needed() const
+{
+    switch(state)
+    {
+    case State::BODY:
+        return received <= DST_INDEX ? DST_INDEX + 1 - received : bodyLen - received;
+    case State::SKIP:
+        return skipLeft;
+    default:
+        return 1;
+    }
+}
+
+
+inline bool FrameParser::complete() const
+{
+    return state == State::COMPLETE;
+}
+
+
+inline bool FrameParser::receiving() const
+{
+    return state != State::SOH && state != State::COMPLETE;
+}
+
+
+inline bool FrameParser::skipping() const
+{
+    return state == State::SKIP;
+}
+
+
+inline void FrameParser::skipped(const uint32_t count)
+{
+    skipLeft -= count;
+    if(skipLeft)
+    {
+        return;
+    }
+
+    state = State::SOH;
+    if(verifying)
+    {
+        if(chks == 0) validCount++;
+        else errorCount++;
+    }
+}
+
+
+inline void FrameParser::skip(const uint32_t count)
+{
+    // bytes are not seen, the checksum can not be verified
+    verifying = false;
+    skipped(count);
+}
+
+
+inline std::span<const uint8_t> FrameParser::frame() const
+{
+    return std::span<const uint8_t>(body, complete() ? bodyLen : 0);
+}
+
+
+inline uint32_t FrameParser::errors() const
+{
+    return errorCount;
+}
+
+
+inline uint32_t FrameParser::valid() const
+{
+    return validCount;
+}
+
+
+inline void FrameParser::reset()
+{
+    state = State::SOH;
+}
+
+
+} // namespace Xerxes
+
+
+#endif // !__FRAME_PARSER_HPP
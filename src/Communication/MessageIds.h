@@ -0,0 +1,28 @@
+#ifndef __MESSAGE_IDS_H
+#define __MESSAGE_IDS_H
+
+#include <xerxes-protocol/MessageId.h>
+
+
+/*
+ * Message ids handled by this firmware on top of the ones defined by xerxes-protocol.
+ */
+
+
+/// @brief Store non-volatile registers to flash now instead of after the commit delay
+const msgid_t MSGID_COMMIT                        = 0x0203;
+
+/// @brief Read several register ranges at once, replies MSGID_READ_VALUE with the ranges concatenated
+const msgid_t MSGID_READ_MULTI                    = 0x0204;
+
+/// @brief Read values changed since the last poll, replies MSGID_READ_VALUE with the change bitmap and the changed values
+const msgid_t MSGID_POLL_CHANGES                  = 0x0205;
+
+/// @brief Switch to the baud rate register once pending replies are sent, broadcast so the whole bus switches together
+const msgid_t MSGID_BAUD_SWITCH                   = 0x0206;
+
+/// @brief Sample sent unasked in the stream slot of a node, payload is sampleCounter, pv0-3 and dv0-3
+const msgid_t MSGID_STREAM_VALUE                  = 0x0207;
+
+
+#endif // !__MESSAGE_IDS_H
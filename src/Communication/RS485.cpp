@@ -1,11 +1,14 @@
 #include "RS485.hpp"
 
 
+#include "pico/time.h"
+
+
 namespace Xerxes
 {
 
 
-RS485::RS485(queue_t *queueTx, queue_t *queueRx) : qtx(queueTx), qrx(queueRx)
+RS485::RS485(TxRing *queueTx, DmaRxRing *ringRx, const uint8_t *address) : qtx(queueTx), rxRing(ringRx), parser(address)
 {
 }
 
@@ -17,117 +20,98 @@ RS485::~RS485()
 
 bool RS485::sendData(const Packet & toSend) const
 {
-    // FIXME: this can check if queue has enough space before trying to send data
-    uint16_t sent {0};
-    for(const auto &el:toSend.getData())
-    {
-        // try to add byte to the queue, if it fails, break the loop
-        if(!queue_try_add(qtx, &el)) break;
-        sent++; // byte was sent successfully
-    }
-
-    
-    // return true if whole packet was sent
-    return sent == toSend.size();
-}
-
-
-bool RS485::readData(const uint64_t timeoutUs, Packet &packet)
-{
-    // start timer
-    uint64_t start = time_us_64();
+    const auto &data = toSend.getData();
 
-    // if RX queue is empty, immediately return
-    if(queue_is_empty(qrx))
+    // queue whole packet or nothing, a partial frame would only garble the bus
+    if(qtx->free() < data.size())
     {
         return false;
     }
 
-    if(receivePacket(timeoutUs))
-    {
-        packet = Packet(incomingMessage);
-        return true;
-    }
-
-    return false;
+    return qtx->push(std::span<const uint8_t>(data)) == data.size();
 }
 
 
-bool RS485::receivePacket(const uint64_t timeoutUs)
+bool RS485::readData([[maybe_unused]] const uint64_t timeoutUs, Packet &packet)
 {
-    // check if the packet is in fifo buffer
-    uint8_t nextVal = 0;
-    
-    #ifdef NDEBUG
-    uint64_t tout = time_us_64() + timeoutUs;
-    #else
-    absolute_time_t tout;
-    tout._private_us_since_boot = time_us_64() + timeoutUs;
-    #endif // NDEBUG
-
-    uint8_t chks = Xerxes::SOH;
-
-    uint8_t msgLen = 0;
-    volatile bool waitForSoh = true;
+    uint8_t chunk[FrameParser::MAX_BODY];
 
-    // clear buffer
-    incomingMessage.clear();
-
-    while(!time_reached(tout))
+    // take only what belongs to the current frame, the rest stays in the ring
+    do
     {
-        if(waitForSoh)
+        uint32_t len;
+
+        if(parser.skipping() && !verifyOthers)
         {
-            if(queue_try_remove(qrx, &nextVal))
-            {
-                if(nextVal == Xerxes::SOH)
-                {
-                    waitForSoh = false;
-                }
-            }
+            // frame for another node, drop the rest of it straight from the ring
+            len = rxRing->skip(parser.needed());
+            parser.skip(len);
         }
         else
         {
-            // SOH was found, get msgLen
-            if(queue_try_remove(qrx, &msgLen))
-            {
-                // add msglen to checksum
-                chks += msgLen;
-                break; //break from this loop, continue to receive all data
-            }
-        }
-    }
-
-    msgLen -= 3; // SOH and len was received, checksum is received at the end hence -3
-    while(!time_reached(tout) && msgLen)
-    {
-        if(queue_try_remove(qrx, &nextVal))
-        {
-            // something was received, slap it to the incoming vector
-            incomingMessage.emplace_back(nextVal);
-            chks += nextVal;
-            msgLen--;
+            len = rxRing->pop(chunk, parser.needed());
+            parser.parse(std::span<const uint8_t>(chunk, len));
         }
-    }
 
-    while(!time_reached(tout))
-    {
-        //wait for checksum byte
-        if(queue_try_remove(qrx, &nextVal))
+        if(!len)
         {
-            chks += nextVal;
-            if(chks == 0)
-            {
-                // successfully received whole message
-                return true;
-            }   
-            else
+            // line went quiet in the middle of a frame, its length was wrong or bytes were lost,
+            // measured from the arrival of the last byte so a busy core0 does not split frames
+            if(parser.receiving() && time_us_32() - rxRing->lastArrivalUs() > gapUs)
             {
-                return false;
+                parser.reset();
             }
+
+            // frame is not complete yet, continue on the next call
+            return false;
         }
-    }
+    } while(!parser.complete());
+
+    auto frame = parser.frame();
+    packet = Packet(std::vector<uint8_t>(frame.begin(), frame.end()));
+    return true;
+}
+
+
+bool RS485::receiving() const
+{
+    return parser.receiving();
+}
+
+
+void RS485::baudrateChanged(const uint32_t baudrate)
+{
+    parser.reset();
+    baud = baudrate;
+
+    // 10 bits per character, long gaps are needed at low baud rates
+    const uint32_t charsUs = FRAME_GAP_CHARS * 10 * 1'000'000 / baudrate;
+    gapUs = charsUs > FRAME_GAP_US ? charsUs : FRAME_GAP_US;
+}
+
 
-    return false;
+uint32_t RS485::baudrate() const
+{
+    return baud;
+}
+
+
+void RS485::verifyOtherFrames(const bool verify)
+{
+    verifyOthers = verify;
+}
+
+
+uint32_t RS485::validFrames() const
+{
+    return parser.valid();
+}
+
+
+uint32_t RS485::frameTimeUs(const uint32_t length) const
+{
+    // 10 bits per character
+    return (static_cast<uint64_t>(length) * 10 * 1'000'000 + baud - 1) / baud;
 }
 
 
@@ -3,7 +3,10 @@
 
 
 #include <xerxes-protocol/Network.hpp>
-#include "pico/util/queue.h"
+#include "Buffer/SpscRing.hpp"
+#include "Communication/DmaRxRing.hpp"
+#include "Communication/FrameParser.hpp"
+#include "Core/Definitions.h"
 #include <xerxes-protocol/Packet.hpp>
 #include <xerxes-protocol/Message.hpp>
 
@@ -14,6 +17,10 @@ namespace Xerxes
 {
 
 
+/// @brief bytes waiting for the transmitter, RS485 produces, main loop consumes
+using TxRing = SpscRing<uint8_t, RX_TX_QUEUE_SIZE>;
+
+
 /**
  * @brief Get amount of time remaining from start to timeout
  * 
@@ -32,29 +39,36 @@ uint32_t remainingTime(const uint64_t & start, const uint64_t &timeout);
 class RS485 : public Network
 {
 private:
-    /// @brief Pointer to the queue for sending data
-    queue_t *qtx;
-    /// @brief Pointer to the queue for receiving data
-    queue_t *qrx;
-    /// @brief Buffer for incoming data
-    std::vector<uint8_t> incomingMessage {};
+    /// @brief Pointer to the ring for sending data
+    TxRing *qtx;
+    /// @brief Pointer to the ring with received data
+    DmaRxRing *rxRing;
+    /// @brief Frame being received, kept across calls
+    FrameParser parser;
+    /// @brief silence which ends a frame in us, depends on the baud rate
+    uint32_t gapUs {FRAME_GAP_US};
+    /// @brief baud rate the UART runs at
+    uint32_t baud {DEFAULT_BAUDRATE};
+    /// @brief parse frames for other nodes instead of dropping them from the ring, to verify them
+    bool verifyOthers {false};
 
 public:
     /**
      * @brief Construct a new RS485 object
      * 
-     * @param queueTx queue for sending data
-     * @param queueRx queue with received data
+     * @param queueTx ring for sending data
+     * @param ringRx ring with received data
+     * @param address own address, frames for other nodes are skipped while they are received
      */
-    RS485(queue_t *queueTx, queue_t *queueRx);
+    RS485(TxRing *queueTx, DmaRxRing *ringRx, const uint8_t *address);
     ~RS485();
 
     /**
      * @brief send one Packet over the network
      * 
      * @param toSend packet to send
-     * @return true if the packet was sent successfully
-     * @return false if the packet was not sent successfully
+     * @return true if the packet was queued for sending
+     * @return false if there is not enough space for the whole packet, nothing is queued
      */
     bool sendData(const Packet & toSend) const;
 
@@ -62,26 +76,56 @@ public:
     /**
      * @brief read one Packet from the network
      * 
-     * @param timeoutUs timeout in us
-     * @return Packet 
+     * Parses the bytes received so far, a partial frame is continued on the next call.
+     * Only broadcast frames and frames for this node are returned. If the line
+     * goes quiet in the middle of a frame, the frame is dropped and the parser
+     * waits for the next SOH, so a corrupted length can not hold it off the bus.
+     * 
+     * @param timeoutUs not used, received bytes are never waited for
+     * @param packet complete packet with valid checksum
+     * @return true if a packet was received
+     * @return false if no complete packet is available yet
      */
     bool readData(const uint64_t timeoutUs, Packet &packet);
-    
+
     /**
-     * @brief check whether there is valid packet in the buffer
+     * @brief check whether part of a frame was received
      * 
-     * @return true valid packet awaits in the incoming buffer
+     * @return true if the rest of a frame is expected
      * @return false otherwise
      */
-    bool receivePacket(const uint64_t timeoutUs);
+    bool receiving() const;
+
+    /**
+     * @brief Drop the frame being received and adapt the frame gap to a new baud rate
+     * 
+     * @param baudrate baud rate the UART runs at now
+     */
+    void baudrateChanged(const uint32_t baudrate);
+
+    /// @brief baud rate the UART runs at, as given to baudrateChanged()
+    uint32_t baudrate() const;
+
+    /**
+     * @brief Verify the checksum of frames for other nodes too
+     * 
+     * Frames for other nodes are dropped from the ring unseen otherwise, set it
+     * while any valid frame on the bus is of interest, e.g. to confirm a baud rate.
+     * 
+     * @param verify true to read and verify frames for other nodes
+     */
+    void verifyOtherFrames(const bool verify);
 
+    /// @brief number of frames received with a valid checksum, see verifyOtherFrames()
+    uint32_t validFrames() const;
 
     /**
-     * @brief parse the packet in the buffer
+     * @brief Time a frame takes on the line at the current baud rate
      * 
-     * @return Packet 
+     * @param length number of bytes of the frame
+     * @return uint32_t time in us, rounded up
      */
-    Packet parsePacket();
+    uint32_t frameTimeUs(const uint32_t length) const;
 };
 
 
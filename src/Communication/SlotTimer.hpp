@@ -0,0 +1,141 @@
+#ifndef __SLOT_TIMER_HPP
+#define __SLOT_TIMER_HPP
+
+
+#include <cstdint>
+
+
+namespace Xerxes
+{
+
+
+/**
+ * @brief Time slot of this node on a time-multiplexed bus
+ *
+ * Every node owns the slot with its index after the sync, slots are slotLen
+ * long and the pattern repeats every period until the next sync. A frame is
+ * sent only if it ends before the slot does, a slot which is too short for
+ * it is skipped and counted as missed instead of sent late into the slot of
+ * the next node.
+ */
+class SlotTimer
+{
+private:
+    /// @brief start of the next slot in us
+    uint64_t nextUs {0};
+    /// @brief time of the last sync in us
+    uint64_t syncTimeUs {0};
+    uint32_t slotLenUs {0};
+    uint32_t periodUs {0};
+    /// @brief slots skipped because the frame did not fit anymore
+    uint32_t missCount {0};
+    bool running {false};
+
+    /// @brief move to the first slot which has not started yet
+    void advance(const uint64_t nowUs);
+
+public:
+    /**
+     * @brief Start counting slots from a sync
+     *
+     * @param syncUs time the sync was received in us
+     * @param slot index of the slot of this node
+     * @param slotLen length of one slot in us
+     * @param period repetition of the slots in us, 0 = once per sync
+     */
+    void start(const uint64_t syncUs, const uint32_t slot, const uint32_t slotLen, const uint32_t period);
+
+    /// @brief Stop until the next start
+    void stop();
+
+    /**
+     * @brief Check if a frame can be sent in the slot of this node now
+     *
+     * While the frame can not go out yet, e.g. the transmitter is busy, the
+     * slot is kept as long as the frame still fits in it.
+     *
+     * @param nowUs current time in us
+     * @param frameUs time the frame takes on the line in us
+     * @param ready true if the frame would go out right away
+     * @return true once per slot, if the whole frame ends inside the slot
+     */
+    bool due(const uint64_t nowUs, const uint32_t frameUs, const bool ready);
+
+    /// @brief number of slots skipped because the frame did not fit anymore
+    uint32_t misses() const;
+
+    /// @brief time of the last sync in us, as given to start()
+    uint64_t syncUs() const;
+};
+
+
+inline void SlotTimer::start(const uint64_t syncUs, const uint32_t slot, const uint32_t slotLen, const uint32_t period)
+{
+    syncTimeUs = syncUs;
+    nextUs = syncUs + static_cast<uint64_t>(slot) * slotLen;
+    slotLenUs = slotLen;
+    periodUs = period;
+    running = true;
+}
+
+
+inline void SlotTimer::stop()
+{
+    running = false;
+}
+
+
+inline void SlotTimer::advance(const uint64_t nowUs)
+{
+    if(!periodUs)
+    {
+        running = false;
+        return;
+    }
+
+    nextUs += ((nowUs - nextUs) / periodUs + 1) * periodUs;
+}
+
+
+inline bool SlotTimer::due(const uint64_t nowUs, const uint32_t frameUs, const bool ready)
+{
+    if(!running || nowUs < nextUs)
+    {
+        return false;
+    }
+
+    // the frame has to end inside the slot, otherwise it collides with the next node
+    const bool fits = nowUs - nextUs + frameUs <= slotLenUs;
+
+    if(fits && !ready)
+    {
+        // try again once the frame can go out
+        return false;
+    }
+
+    if(!fits)
+    {
+        missCount++;
+    }
+
+    advance(nowUs);
+    return fits;
+}
+
+
+inline uint32_t SlotTimer::misses() const
+{
+    return missCount;
+}
+
+
+inline uint64_t SlotTimer::syncUs() const
+{
+    return syncTimeUs;
+}
+
+
+} // namespace Xerxes
+
+
+#endif // !__SLOT_TIMER_HPP
@@ -28,7 +28,7 @@ std::function<void(const Xerxes::Message &)> unicast(Func f)
   // The returned function is a lambda function that takes the same arguments as the original
   // function and calls it with the given arguments.
     return [f](const Xerxes::Message &msg) {
-        if(msg.dstAddr!= 0xff && *_reg.devAddress == msg.dstAddr)
+        if(msg.dstAddr!= 0xff && *_reg.devAddress() == msg.dstAddr)
         {
         // Call the original function with the given arguments.
             f(msg);
@@ -54,7 +54,7 @@ template <typename Func>
 std::function<void(const Xerxes::Message &)> broadcast(Func f) 
 {
     return [f](const Xerxes::Message &msg) {
-        if(msg.dstAddr == 0xff || *_reg.devAddress == msg.dstAddr)
+        if(msg.dstAddr == 0xff || *_reg.devAddress() == msg.dstAddr)
         {
         // Call the original function with the given arguments.
             f(msg);
@@ -4,8 +4,16 @@
 #include "hardware/flash.h"
 #include "hardware/clocks.h"
 
-/** @brief Default baudrate for serial communication */
+/** @brief Default baudrate for serial communication, also the fallback if no frame arrives at the configured one */
 #define DEFAULT_BAUDRATE            115200 
+/** @brief Range of baudrates accepted from the baud rate register, UART clock is 48 MHz */
+#define BAUD_RATE_MIN               9600
+#define BAUD_RATE_MAX               3'000'000
+/** @brief Silence on the line in the middle of a frame which ends it, at least FRAME_GAP_CHARS characters */
+#ifndef FRAME_GAP_US
+#define FRAME_GAP_US                1000
+#endif // !FRAME_GAP_US
+#define FRAME_GAP_CHARS             4
 
 #define VOLATILE_OFFSET             FLASH_PAGE_SIZE       // 256 bytes
 #define READ_ONLY_OFFSET            FLASH_PAGE_SIZE * 2   // 512 bytes
@@ -14,15 +22,37 @@
 
 #define RX_TX_QUEUE_SIZE            256 ///< 256 bytes
 #define FIFO_DEPTH                  32  ///< 32 bytes
+#define REGISTER_WRITE_MAX_LEN      RX_TX_QUEUE_SIZE    ///< max bytes of one register write
+#define PENDING_WRITES_DEPTH        4   ///< register writes waiting for core1, power of two
+#define PENDING_SYNCS_DEPTH         4   ///< syncs waiting for core1 to sample, power of two
+#define READ_MULTI_MAX_LEN          240 ///< max bytes returned by one multi-range read, reply must fit into tx queue
 
 /// @brief Use last sector of flash for storing data
 #define FLASH_TARGET_OFFSET         PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE
 
-// how many samples are rotated in ring buffer
+// how many samples are rotated in ring buffer, rounded up to power of two by sensors
 #ifndef RING_BUFFER_LEN
 #define RING_BUFFER_LEN     100
 #endif // !RING_BUFFER_LEN
 
+// default quantiles, see QUANTILE_P_OFFSET, estimated while MASK_CONFIG_QUANTILES is set
+#ifndef QUANTILE_P0
+#define QUANTILE_P0         0.50f   // median
+#endif // !QUANTILE_P0
+#ifndef QUANTILE_P1
+#define QUANTILE_P1         0.95f
+#endif // !QUANTILE_P1
+#ifndef QUANTILE_P2
+#define QUANTILE_P2         0.99f
+#endif // !QUANTILE_P2
+// samples per quantile window, needs well over 1 / (1 - p) samples or quantile p is just the maximum
+#ifndef QUANTILE_WINDOW_LEN
+#define QUANTILE_WINDOW_LEN 1024
+#endif // !QUANTILE_WINDOW_LEN
+
+/// @brief number of process values, each per process value register field holds one element per channel
+#define PV_CHANNELS         4
+
 // ############################### //
 // BEGIN OF MEMORY MAPPING OFFSETS //
 // ############################### //
@@ -49,6 +79,74 @@
 // memory offset of address of the device (1 byte)
 #define OFFSET_ADDRESS              44
 
+// memory offset of the alarm enable bits (2 bytes), same layout as the alarm register
+#define ALARM_ENABLE_OFFSET         46
+
+// memory offset of the filter type of the process values (1 byte each), see FilterType
+#define FILTER_TYPE_PV0_OFFSET      48
+#define FILTER_TYPE_PV1_OFFSET      49
+#define FILTER_TYPE_PV2_OFFSET      50
+#define FILTER_TYPE_PV3_OFFSET      51
+
+// memory offset of the EMA alpha of the process values (4 bytes each, fixed point, 65536 = 1.0)
+#define FILTER_ALPHA_PV0_OFFSET     52
+#define FILTER_ALPHA_PV1_OFFSET     56
+#define FILTER_ALPHA_PV2_OFFSET     60
+#define FILTER_ALPHA_PV3_OFFSET     64
+
+// memory offset of the biquad coefficients b0, b1, b2, a1, a2 of the process values
+// (20 bytes each, fixed point int32, 1 << 28 = 1.0)
+#define FILTER_BIQUAD_PV0_OFFSET    68
+#define FILTER_BIQUAD_PV1_OFFSET    88
+#define FILTER_BIQUAD_PV2_OFFSET    108
+#define FILTER_BIQUAD_PV3_OFFSET    128
+
+// memory offset of the deadbands of the process values (4 bytes each, float)
+// process value is reported as changed when it moves more than deadband from the last reported value
+#define DEADBAND_PV0_OFFSET         148
+#define DEADBAND_PV1_OFFSET         152
+#define DEADBAND_PV2_OFFSET         156
+#define DEADBAND_PV3_OFFSET         160
+
+// memory offset of the high alarm thresholds of the process values (4 bytes each, float)
+#define ALARM_HIGH_PV0_OFFSET       164
+#define ALARM_HIGH_PV1_OFFSET       168
+#define ALARM_HIGH_PV2_OFFSET       172
+#define ALARM_HIGH_PV3_OFFSET       176
+
+// memory offset of the low alarm thresholds of the process values (4 bytes each, float)
+#define ALARM_LOW_PV0_OFFSET        180
+#define ALARM_LOW_PV1_OFFSET        184
+#define ALARM_LOW_PV2_OFFSET        188
+#define ALARM_LOW_PV3_OFFSET        192
+
+// memory offset of the alarm hysteresis of the process values (4 bytes each, float)
+// alarm clears when the value returns past its threshold by more than the hysteresis
+#define ALARM_HYST_PV0_OFFSET       196
+#define ALARM_HYST_PV1_OFFSET       200
+#define ALARM_HYST_PV2_OFFSET       204
+#define ALARM_HYST_PV3_OFFSET       208
+
+// memory offset of the baud rate of the RS485 link (4 bytes), applied at boot or by MSGID_BAUD_SWITCH
+#define BAUD_RATE_OFFSET            212
+
+// memory offsets of the stream mode slot, see MASK_CONFIG_STREAM (4 bytes each)
+// after a broadcast sync the node sends its sample in slot <index>, slots are <length> us long
+// and repeat every <period> us until the next sync, period 0 = once per sync
+#define STREAM_SLOT_OFFSET          216
+#define STREAM_SLOT_LEN_US_OFFSET   220
+#define STREAM_PERIOD_US_OFFSET     224
+// stream frame is SOH, LEN, SRC, DST, 2 bytes of MSGID, sampleCounter, pv0-3, dv0-3 and CHKS
+#define STREAM_FRAME_LEN            43
+
+// memory offset of the time in us without a valid frame on the bus after which an unconfirmed
+// baud rate is given up (4 bytes), out of range = BAUD_FALLBACK_TIMEOUT_US
+#define BAUD_FALLBACK_US_OFFSET     228
+
+// memory offset of the quantiles estimated for QUANTILE0..2 registers (3 x 4 bytes, float)
+// out of range (0, 1) = QUANTILE_P0..2, changing them restarts the quantile window
+#define QUANTILE_P_OFFSET           232
+
 // ############################# //
 // ###### Volatile range ####### //
 // ############################# //
@@ -94,9 +192,55 @@
 #define AV2_OFFSET                  VOLATILE_OFFSET + 104     // 360
 #define AV3_OFFSET                  VOLATILE_OFFSET + 108     // 364
 
+// memory offset of the changed values bitmap, bits 0-3 = pv0-3, bits 4-7 = dv0-3 (1 byte)
+// cleared when read
+#define CHANGED_MASK_OFFSET         VOLATILE_OFFSET + 112     // 368
+
 // memory offset for the safety lock of the device memory (1 byte)
 #define MEM_UNLOCKED_OFFSET         VOLATILE_OFFSET + 128     // 384
 
+// memory offset of the mean values of the process values over 10 s window
+#define MEAN_10S_PV0_OFFSET         VOLATILE_OFFSET + 136     // 392
+#define MEAN_10S_PV1_OFFSET         VOLATILE_OFFSET + 140     // 396
+#define MEAN_10S_PV2_OFFSET         VOLATILE_OFFSET + 144     // 400
+#define MEAN_10S_PV3_OFFSET         VOLATILE_OFFSET + 148     // 404
+
+// memory offset of the standard deviation of the process values over 10 s window
+#define STDDEV_10S_PV0_OFFSET       VOLATILE_OFFSET + 152     // 408
+#define STDDEV_10S_PV1_OFFSET       VOLATILE_OFFSET + 156     // 412
+#define STDDEV_10S_PV2_OFFSET       VOLATILE_OFFSET + 160     // 416
+#define STDDEV_10S_PV3_OFFSET       VOLATILE_OFFSET + 164     // 420
+
+// memory offset of the mean values of the process values over 60 s window
+#define MEAN_60S_PV0_OFFSET         VOLATILE_OFFSET + 168     // 424
+#define MEAN_60S_PV1_OFFSET         VOLATILE_OFFSET + 172     // 428
+#define MEAN_60S_PV2_OFFSET         VOLATILE_OFFSET + 176     // 432
+#define MEAN_60S_PV3_OFFSET         VOLATILE_OFFSET + 180     // 436
+
+// memory offset of the standard deviation of the process values over 60 s window
+#define STDDEV_60S_PV0_OFFSET       VOLATILE_OFFSET + 184     // 440
+#define STDDEV_60S_PV1_OFFSET       VOLATILE_OFFSET + 188     // 444
+#define STDDEV_60S_PV2_OFFSET       VOLATILE_OFFSET + 192     // 448
+#define STDDEV_60S_PV3_OFFSET       VOLATILE_OFFSET + 196     // 452
+
+// memory offset of the quantile quantileP[0] of the process values (median by default)
+#define QUANTILE0_PV0_OFFSET        VOLATILE_OFFSET + 200     // 456
+#define QUANTILE0_PV1_OFFSET        VOLATILE_OFFSET + 204     // 460
+#define QUANTILE0_PV2_OFFSET        VOLATILE_OFFSET + 208     // 464
+#define QUANTILE0_PV3_OFFSET        VOLATILE_OFFSET + 212     // 468
+
+// memory offset of the quantile quantileP[1] of the process values (P95 by default)
+#define QUANTILE1_PV0_OFFSET        VOLATILE_OFFSET + 216     // 472
+#define QUANTILE1_PV1_OFFSET        VOLATILE_OFFSET + 220     // 476
+#define QUANTILE1_PV2_OFFSET        VOLATILE_OFFSET + 224     // 480
+#define QUANTILE1_PV3_OFFSET        VOLATILE_OFFSET + 228     // 484
+
+// memory offset of the quantile quantileP[2] of the process values (P99 by default)
+#define QUANTILE2_PV0_OFFSET        VOLATILE_OFFSET + 232     // 488
+#define QUANTILE2_PV1_OFFSET        VOLATILE_OFFSET + 236     // 492
+#define QUANTILE2_PV2_OFFSET        VOLATILE_OFFSET + 240     // 496
+#define QUANTILE2_PV3_OFFSET        VOLATILE_OFFSET + 244     // 500
+
 // ############################# //
 // ###### READ ONLY RANGE ###### //
 // ############################# //
@@ -107,19 +251,39 @@
 #define ERROR_OFFSET                READ_ONLY_OFFSET + 8    // 520
 // memory offset of the uid of the device (8 bytes)
 #define UID_OFFSET                  READ_ONLY_OFFSET + 16   // 528
+// memory offset of the latched alarms (8 bytes), see ALARM_MASK_*, cleared to active alarms when read
+#define ALARM_OFFSET                READ_ONLY_OFFSET + 24   // 536
 
 // memory offset of the net cycle time (4 bytes)
 #define OFFSET_NET_CYCLE_TIME       READ_ONLY_OFFSET + 32   // 544
+// memory offset of the sample counter, incremented with every new sample (4 bytes)
+#define SAMPLE_COUNTER_OFFSET       READ_ONLY_OFFSET + 36   // 548
+// memory offset of the capture time of the last sample in microseconds since boot (8 bytes)
+#define CAPTURE_TIME_US_OFFSET      READ_ONLY_OFFSET + 40   // 552
 
 // ############################# //
 // END of memory mapping offsets //
 // ############################# //
 
+/* alarm masks, n = channel 0-3 */
+/* process value n is above its high threshold */
+#define ALARM_MASK_HIGH(n)          (1 << (n))
+/* process value n is below its low threshold */
+#define ALARM_MASK_LOW(n)           (1 << ((n) + 4))
+/* discrete value n changed */
+#define ALARM_MASK_DV_EDGE(n)       (1 << ((n) + 8))
+
 /* config masks */
 /* If true use free run, if false: wait for sync packet */
 #define MASK_CONFIG_FREE_RUN        1<<0
 /* if true, enable automatic calculation of the statistics */
 #define MASK_CONFIG_CALC_STATS      1<<1
+/* if true, statistics are calculated only when the statistics registers are read */
+#define MASK_CONFIG_LAZY_STATS      1<<2
+/* if true, send the sample in own time slot after broadcast sync, without being polled */
+#define MASK_CONFIG_STREAM          1<<3
+/* if true, estimate quantiles of the process values, needs MASK_CONFIG_CALC_STATS */
+#define MASK_CONFIG_QUANTILES       1<<4
 
 
 /* Default values */
@@ -127,6 +291,19 @@
 #define DEFAULT_CYCLE_TIME_US       10000     // 10 ms
 #endif // !DEFAULT_CYCLE_TIME_US
 
+/// @brief non-volatile writes are committed to flash this long after the last change
+#ifndef NV_COMMIT_DELAY_US
+#define NV_COMMIT_DELAY_US          500'000     // 0.5 s
+#endif // !NV_COMMIT_DELAY_US
+
+/// @brief baud rate falls back to DEFAULT_BAUDRATE if no valid frame arrives this long after a switch
+#ifndef BAUD_FALLBACK_TIMEOUT_US
+#define BAUD_FALLBACK_TIMEOUT_US    10'000'000  // 10 s
+#endif // !BAUD_FALLBACK_TIMEOUT_US
+/// @brief range of the baud fallback register, blank or corrupted values use BAUD_FALLBACK_TIMEOUT_US
+#define BAUD_FALLBACK_MIN_US        100'000         // 0.1 s
+#define BAUD_FALLBACK_MAX_US        600'000'000     // 10 min
+
 #ifndef DEFAULT_WATCHDOG_DELAY
 #define DEFAULT_WATCHDOG_DELAY      200         // ms
 #endif // !DEFAULT_WATCHDOG_DELAY
@@ -174,9 +351,9 @@ constexpr uint32_t MEM_UNLOCKED_VAL = 0x55AA55AA;
 typedef struct {
     bool freeRun :    1; // enable free run of sensor
     bool calcStat :   1; // enable calculation of statistics
-    bool bit2 :       1;
-    bool bit3 :       1;
-    bool bit4 :       1;
+    bool lazyStat :   1; // calculate statistics on demand, when they are read
+    bool stream :     1; // send samples in own time slot after broadcast sync
+    bool quantiles :  1; // estimate quantiles of process values, costs float math per sample
     bool bit5 :       1;
     bool bit6 :       1;
     bool bit7 :       1;
@@ -1,5 +1,8 @@
 #include "Core/Register.hpp"
 
+#include <cmath>
+#include <cstring>
+
 
 namespace Xerxes
 {
@@ -15,21 +18,153 @@ Register::~Register()
 }
 
 
+void Register::publish()
+{
+    published.write(memTable);
+}
+
+
+void Register::publish(const uint16_t offset, const uint16_t len)
+{
+    published.write(memTable, offset, len);
+}
+
+
+void Register::readPublished(uint8_t* dst, const uint16_t offset, const uint16_t len) const
+{
+    published.read(dst, offset, len);
+}
+
+
+bool Register::apply(const RegisterWrite& write)
+{
+    bool changed = false;
+
+    // extend dirty range by non-volatile bytes whose value actually changes
+    for(uint16_t i = write.offset; i < write.offset + write.len && i < VOLATILE_OFFSET; i++)
+    {
+        if(memTable[i] != write.data[i - write.offset])
+        {
+            if(i < nvDirtyBegin) nvDirtyBegin = i;
+            if(i + 1 > nvDirtyEnd) nvDirtyEnd = i + 1;
+            changed = true;
+        }
+    }
+
+    std::memcpy(memTable + write.offset, write.data, write.len);
+    return changed;
+}
+
+
+bool Register::nvDirty() const
+{
+    return nvDirtyBegin < nvDirtyEnd;
+}
+
+
+void Register::nvClean()
+{
+    nvDirtyBegin = VOLATILE_OFFSET;
+    nvDirtyEnd = 0;
+}
+
+
+void Register::stampSample(const uint64_t timeUs)
+{
+    (*sampleCounter())++;
+    *captureTimeUs() = timeUs;
+
+    trackChanges();
+    evaluateAlarms();
+}
+
+
+void Register::evaluateAlarms()
+{
+    const uint16_t enabled = *alarmEnable();
+    uint16_t active = alarmActive;
+    uint16_t edges = 0;
+
+    for(uint8_t i = 0; i < PV_CHANNELS; i++)
+    {
+        const float value = pv()[i];
+        const float high = alarmHighPv()[i];
+        const float low = alarmLowPv()[i];
+        const float hysteresis = alarmHystPv()[i];
+
+        // raise above the threshold, clear only when back by more than hysteresis
+        if(value > high) active |= ALARM_MASK_HIGH(i);
+        else if(value < high - hysteresis) active &= ~ALARM_MASK_HIGH(i);
+
+        if(value < low) active |= ALARM_MASK_LOW(i);
+        else if(value > low + hysteresis) active &= ~ALARM_MASK_LOW(i);
+
+        if(dv()[i] != previousDv[i])
+        {
+            previousDv[i] = dv()[i];
+            edges |= ALARM_MASK_DV_EDGE(i);
+        }
+    }
+
+    alarmActive = active & enabled;
+    *alarm() |= (alarmActive | edges) & enabled;
+}
+
+
+void Register::acknowledge(const bool changes, const bool alarms)
+{
+    if(changes)
+    {
+        *changedMask() = 0;
+    }
+
+    if(alarms)
+    {
+        *alarm() = alarmActive;
+    }
+}
+
+
+void Register::trackChanges()
+{
+    uint8_t changed = *changedMask();
+
+    for(uint8_t i = 0; i < PV_CHANNELS; i++)
+    {
+        const float value = pv()[i];
+        if(std::fabs(value - reportedPv[i]) > deadbandPv()[i])
+        {
+            reportedPv[i] = value;
+            changed |= 1 << i;
+        }
+
+        // discrete values have no deadband, any change is reported
+        if(dv()[i] != reportedDv[i])
+        {
+            reportedDv[i] = dv()[i];
+            changed |= 1 << (i + 4);
+        }
+    }
+
+    *changedMask() = changed;
+}
+
+
 void Register::errorSet(const uint64_t& errorBit)
 {
-    bitSet(*error, errorBit);
+    bitSet(*error(), errorBit);
 }
 
 
 void Register::errorClear(const uint64_t& errorBit)
 {
-    bitClear(*error, errorBit);
+    bitClear(*error(), errorBit);
 }
 
 
 bool Register::errorCheck(const uint64_t& errorBit)
 {
-    return (*error & errorBit);
+    return (*error() & errorBit);
 }
 
 
@@ -3,6 +3,9 @@
 
 
 #include "Core/Definitions.h"
+#include "Core/RegisterMap.hpp"
+#include "Buffer/SeqLockBuffer.hpp"
+#include "Buffer/SpscRing.hpp"
 
 
 namespace Xerxes
@@ -98,6 +101,24 @@ bool bitCheck(T& reg, const uint8_t n)
 }
     
 
+/**
+ * @brief Write to the register received from the master, applied by core1 between samples
+ * 
+ */
+struct RegisterWrite
+{
+    uint16_t offset;
+    uint16_t len;
+    uint8_t data[REGISTER_WRITE_MAX_LEN];
+    /// @brief address of the master, acknowledged once the write is applied
+    uint8_t master;
+};
+
+
+/// @brief writes passed from the communication core to core1
+using WriteRing = SpscRing<RegisterWrite, PENDING_WRITES_DEPTH>;
+
+
 /**
  * @brief Register class for storing all data in memory mapped registers
  * 
@@ -107,82 +128,114 @@ bool bitCheck(T& reg, const uint8_t n)
  * memory mapped registers, the data can be accessed directly through the
  * communication interface.
  * 
+ * memTable is the working copy, owned by the writer of the measurement cycle.
+ * At the end of each cycle it is published into a seqlock protected snapshot,
+ * the communication core reads only the snapshot so it always gets values
+ * of a single cycle without pausing the measurement.
+ * 
  */
 class Register
 {
 private:
+    /// @brief memTable as of the end of the last cycle
+    SeqLockBuffer<REGISTER_SIZE> published;
 
+    /// @brief non-volatile bytes changed since the last commit, empty if begin >= end
+    uint16_t nvDirtyBegin {VOLATILE_OFFSET};
+    uint16_t nvDirtyEnd {0};
 
-public:
-    Register(/* args */);
-    ~Register();
-
-    uint8_t memTable[REGISTER_SIZE];
-
-    float* gainPv0       = (float *)(memTable + GAIN_PV0_OFFSET);
-    float* gainPv1       = (float *)(memTable + GAIN_PV1_OFFSET);
-    float* gainPv2       = (float *)(memTable + GAIN_PV2_OFFSET);
-    float* gainPv3       = (float *)(memTable + GAIN_PV3_OFFSET);
-
-
-    float* offsetPv0     = (float *)(memTable + OFFSET_PV0_OFFSET);
-    float* offsetPv1     = (float *)(memTable + OFFSET_PV1_OFFSET);
-    float* offsetPv2     = (float *)(memTable + OFFSET_PV2_OFFSET);
-    float* offsetPv3     = (float *)(memTable + OFFSET_PV3_OFFSET);
-
-    uint32_t *desiredCycleTimeUs     = (uint32_t *)(memTable + OFFSET_DESIRED_CYCLE_TIME);  ///< Desired cycle time of sensor loop in microseconds
-    uint8_t *devAddress              = (uint8_t *)(memTable + OFFSET_ADDRESS);  ///< Address of the device (1 byte)
-    ConfigBitsUnion *config          = (ConfigBitsUnion *)(memTable + OFFSET_CONFIG_BITS);  ///< Config bits of the device (1 byte)
-    uint32_t *netCycleTimeUs         = (uint32_t *)(memTable + OFFSET_NET_CYCLE_TIME);  ///< Actual cycle time of measurement loop in microseconds
-
-
-    /* ### VOLATILE - PROCESS VALUES ### */
-    float* pv0           = (float *)(memTable + PV0_OFFSET);    ///< Pointer to process value 0
-    float* pv1           = (float *)(memTable + PV1_OFFSET);    ///< Pointer to process value 1
-    float* pv2           = (float *)(memTable + PV2_OFFSET);    ///< Pointer to process value 2
-    float* pv3           = (float *)(memTable + PV3_OFFSET);    ///< Pointer to process value 3
-
-    float* meanPv0       = (float *)(memTable + MEAN_PV0_OFFSET);
-    float* meanPv1       = (float *)(memTable + MEAN_PV1_OFFSET);
-    float* meanPv2       = (float *)(memTable + MEAN_PV2_OFFSET);
-    float* meanPv3       = (float *)(memTable + MEAN_PV3_OFFSET);
+    /// @brief values of pv0-3 and dv0-3 when their change was last reported
+    float reportedPv[PV_CHANNELS] {};
+    uint32_t reportedDv[PV_CHANNELS] {};
 
-    float* stdDevPv0     = (float *)(memTable + STDDEV_PV0_OFFSET);
-    float* stdDevPv1     = (float *)(memTable + STDDEV_PV1_OFFSET);
-    float* stdDevPv2     = (float *)(memTable + STDDEV_PV2_OFFSET);
-    float* stdDevPv3     = (float *)(memTable + STDDEV_PV3_OFFSET);
+    /// @brief Set bits of changedMask for values which moved out of their deadband
+    void trackChanges();
 
-    float* minPv0        = (float *)(memTable + MIN_PV0_OFFSET);
-    float* minPv1        = (float *)(memTable + MIN_PV1_OFFSET);
-    float* minPv2        = (float *)(memTable + MIN_PV2_OFFSET);
-    float* minPv3        = (float *)(memTable + MIN_PV3_OFFSET);
+    /// @brief alarms whose condition holds now, with hysteresis
+    uint16_t alarmActive {0};
+    /// @brief discrete values of the previous sample, for edge alarms
+    uint32_t previousDv[PV_CHANNELS] {};
 
-    float* maxPv0        = (float *)(memTable + MAX_PV0_OFFSET);
-    float* maxPv1        = (float *)(memTable + MAX_PV1_OFFSET);
-    float* maxPv2        = (float *)(memTable + MAX_PV2_OFFSET);
-    float* maxPv3        = (float *)(memTable + MAX_PV3_OFFSET);
+    /// @brief Update active alarms and latch them into the alarm register
+    void evaluateAlarms();
 
-    uint32_t* dv0       = (uint32_t *)(memTable + DV0_OFFSET);  ///< Pointer to digital value 0
-    uint32_t* dv1       = (uint32_t *)(memTable + DV1_OFFSET);  ///< Pointer to digital value 1
-    uint32_t* dv2       = (uint32_t *)(memTable + DV2_OFFSET);  ///< Pointer to digital value 2
-    uint32_t* dv3       = (uint32_t *)(memTable + DV3_OFFSET);  ///< Pointer to digital value 3
-
-    float* av0          = (float *)(memTable + AV0_OFFSET);    ///< Pointer to analog value 0
-    float* av1          = (float *)(memTable + AV1_OFFSET);    ///< Pointer to analog value 1
-    float* av2          = (float *)(memTable + AV2_OFFSET);    ///< Pointer to analog value 2
-    float* av3          = (float *)(memTable + AV3_OFFSET);    ///< Pointer to analog value 3
-
-    /** @brief 0x55AA55AA = unlocked, anything else = locked */
-    uint32_t* memUnlocked   = (uint32_t *)(memTable + MEM_UNLOCKED_OFFSET);
-
-    /* ### READ ONLY VALUES ### */
-    uint64_t* error      = (uint64_t *)(memTable + ERROR_OFFSET);   ///< Error register, holds error codes
-    uint64_t* status     = (uint64_t *)(memTable + STATUS_OFFSET);  ///< Status register, holds status codes
-    uint64_t* uid        = (uint64_t *)(memTable + UID_OFFSET);     ///< Unique ID of the device
-
-    /* ### MESSAGE STRING MEMORY ### */
-    char* message    = (char *)(memTable + MESSAGE_OFFSET); ///< Message string, holds messages (debug, info, warning, error)
+public:
+    Register(/* args */);
+    ~Register();
 
+    alignas(8) uint8_t memTable[REGISTER_SIZE];
+
+    /**
+     * @brief Typed accessors of the register fields, generated from XERXES_REGISTER_MAP
+     * 
+     * Each accessor returns a pointer to the field inside memTable, offset is a
+     * compile time constant so the access compiles to a direct load/store.
+     */
+#define XERXES_REGISTER_ACCESSOR(name, offset, type, count, access) \
+    type* name() { return reinterpret_cast<type *>(memTable + (offset)); }
+
+    XERXES_REGISTER_MAP(XERXES_REGISTER_ACCESSOR)
+
+#undef XERXES_REGISTER_ACCESSOR
+
+#define XERXES_REGISTER_CHANNEL_ACCESSOR(array, stride, ch0, ch1, ch2, ch3) \
+    auto ch0() { return array() + 0 * (stride); } \
+    auto ch1() { return array() + 1 * (stride); } \
+    auto ch2() { return array() + 2 * (stride); } \
+    auto ch3() { return array() + 3 * (stride); }
+
+    XERXES_REGISTER_CHANNELS(XERXES_REGISTER_CHANNEL_ACCESSOR)
+
+#undef XERXES_REGISTER_CHANNEL_ACCESSOR
+
+
+    /// @brief Publish memTable as the snapshot read by the communication core
+    /// @note call from one writer at a time, at the end of the cycle
+    void publish();
+
+    /// @brief Publish a range of memTable, the rest of the snapshot is kept
+    /// @param offset first byte of the range
+    /// @param len number of bytes, offset + len <= REGISTER_SIZE
+    /// @note call from one writer at a time, for fields the sample does not write
+    void publish(const uint16_t offset, const uint16_t len);
+
+    /// @brief Copy a range of the last published snapshot
+    /// @param dst destination, at least len bytes
+    /// @param offset first byte of the range
+    /// @param len number of bytes, offset + len <= REGISTER_SIZE
+    void readPublished(uint8_t* dst, const uint16_t offset, const uint16_t len) const;
+
+    /// @brief Copy several ranges of the same published snapshot
+    /// @tparam F callable as copy(const uint8_t* snapshot), may be called again if core1 published meanwhile
+    /// @param copy copies the ranges it needs from the snapshot
+    template <class F>
+    void readPublishedWith(F copy) const
+    {
+        published.readWith(copy);
+    }
+
+    /// @brief Apply a write of the master to memTable, track changes of non-volatile range
+    /// @param write range and data, checked by the receiver
+    /// @return true if content of the non-volatile range changed
+    bool apply(const RegisterWrite& write);
+
+    /// @brief Check if the non-volatile range changed since the last commit
+    bool nvDirty() const;
+
+    /// @brief Mark the non-volatile range as committed to flash
+    void nvClean();
+
+    /// @brief Mark process values as a new sample, published together with them
+    /// 
+    /// Increments sample counter, stores capture time, flags changed values in changedMask
+    /// and evaluates alarms.
+    /// @param timeUs capture time of the sample, time_us_64()
+    void stampSample(const uint64_t timeUs);
+
+    /// @brief Acknowledge latched registers after the master read them
+    /// @param changes changedMask was read, clear it
+    /// @param alarms alarm register was read, keep only alarms still active
+    void acknowledge(const bool changes, const bool alarms);
 
     /// @brief Set the error bit
     /// @param errorBit 
@@ -0,0 +1,283 @@
+#ifndef __REGISTER_MAP_HPP
+#define __REGISTER_MAP_HPP
+
+#include <array>
+#include <cstdint>
+
+#include "Core/Definitions.h"
+
+
+namespace Xerxes
+{
+
+
+/**
+ * @brief Register map of the device, one line per field
+ *
+ * X(name, offset, type, count, access) - field of count elements of type at offset,
+ * access is one of NV (non volatile, stored in flash), VOLATILE or READ_ONLY.
+ * Register accessors, field descriptors and permission checks are generated from
+ * this table, offsets are defined in Core/Definitions.h. Per process value fields
+ * are one array entry of PV_CHANNELS elements so the checks cover indexing by channel.
+ */
+#define XERXES_REGISTER_MAP(X) \
+    /* ### NON VOLATILE - CALIBRATION AND CONFIGURATION ### */ \
+    X(gainPv,               GAIN_PV0_OFFSET,            float,              PV_CHANNELS, NV) \
+    X(offsetPv,             OFFSET_PV0_OFFSET,          float,              PV_CHANNELS, NV) \
+    /* desired cycle time of sensor loop in microseconds */ \
+    X(desiredCycleTimeUs,   OFFSET_DESIRED_CYCLE_TIME,  uint32_t,           1,  NV) \
+    X(config,               OFFSET_CONFIG_BITS,         ConfigBitsUnion,    1,  NV) \
+    X(devAddress,           OFFSET_ADDRESS,             uint8_t,            1,  NV) \
+    /* enabled alarms, see ALARM_MASK_* */ \
+    X(alarmEnable,          ALARM_ENABLE_OFFSET,        uint16_t,           1,  NV) \
+    /* filter type of process values, see FilterType */ \
+    X(filterTypePv,         FILTER_TYPE_PV0_OFFSET,     uint8_t,            PV_CHANNELS, NV) \
+    /* EMA alpha of process values, fixed point */ \
+    X(filterAlphaPv,        FILTER_ALPHA_PV0_OFFSET,    uint32_t,           PV_CHANNELS, NV) \
+    /* biquad coefficients b0, b1, b2, a1, a2 of process values, fixed point */ \
+    X(filterBiquadPv,       FILTER_BIQUAD_PV0_OFFSET,   int32_t,            5 * PV_CHANNELS, NV) \
+    /* change of process values reported by changedMask */ \
+    X(deadbandPv,           DEADBAND_PV0_OFFSET,        float,              PV_CHANNELS, NV) \
+    /* alarm thresholds and hysteresis of process values */ \
+    X(alarmHighPv,          ALARM_HIGH_PV0_OFFSET,      float,              PV_CHANNELS, NV) \
+    X(alarmLowPv,           ALARM_LOW_PV0_OFFSET,       float,              PV_CHANNELS, NV) \
+    X(alarmHystPv,          ALARM_HYST_PV0_OFFSET,      float,              PV_CHANNELS, NV) \
+    /* baud rate of the RS485 link, out of range = DEFAULT_BAUDRATE */ \
+    X(baudRate,             BAUD_RATE_OFFSET,           uint32_t,           1,  NV) \
+    /* time slot of this node in stream mode */ \
+    X(streamSlot,           STREAM_SLOT_OFFSET,         uint32_t,           1,  NV) \
+    X(streamSlotLenUs,      STREAM_SLOT_LEN_US_OFFSET,  uint32_t,           1,  NV) \
+    X(streamPeriodUs,       STREAM_PERIOD_US_OFFSET,    uint32_t,           1,  NV) \
+    /* time without a valid frame before an unconfirmed baud rate is given up, out of range = BAUD_FALLBACK_TIMEOUT_US */ \
+    X(baudFallbackUs,       BAUD_FALLBACK_US_OFFSET,    uint32_t,           1,  NV) \
+    /* quantiles published in quantile0Pv..quantile2Pv, out of range (0, 1) = QUANTILE_P0..2 */ \
+    X(quantileP,            QUANTILE_P_OFFSET,          float,              3,  NV) \
+    /* ### VOLATILE - PROCESS VALUES ### */ \
+    X(pv,                   PV0_OFFSET,                 float,              PV_CHANNELS, VOLATILE) \
+    X(meanPv,               MEAN_PV0_OFFSET,            float,              PV_CHANNELS, VOLATILE) \
+    X(stdDevPv,             STDDEV_PV0_OFFSET,          float,              PV_CHANNELS, VOLATILE) \
+    X(minPv,                MIN_PV0_OFFSET,             float,              PV_CHANNELS, VOLATILE) \
+    X(maxPv,                MAX_PV0_OFFSET,             float,              PV_CHANNELS, VOLATILE) \
+    /* discrete values, eg. digital inputs and outputs */ \
+    X(dv,                   DV0_OFFSET,                 uint32_t,           PV_CHANNELS, VOLATILE) \
+    /* additional (analog) values */ \
+    X(av,                   AV0_OFFSET,                 float,              PV_CHANNELS, VOLATILE) \
+    /* values changed since last read, bits 0-3 = pv0-3, bits 4-7 = dv0-3 */ \
+    X(changedMask,          CHANGED_MASK_OFFSET,        uint8_t,            1,  VOLATILE) \
+    /* 0x55AA55AA = unlocked, anything else = locked */ \
+    X(memUnlocked,          MEM_UNLOCKED_OFFSET,        uint32_t,           1,  VOLATILE) \
+    X(mean10sPv,            MEAN_10S_PV0_OFFSET,        float,              PV_CHANNELS, VOLATILE) \
+    X(stdDev10sPv,          STDDEV_10S_PV0_OFFSET,      float,              PV_CHANNELS, VOLATILE) \
+    X(mean60sPv,            MEAN_60S_PV0_OFFSET,        float,              PV_CHANNELS, VOLATILE) \
+    X(stdDev60sPv,          STDDEV_60S_PV0_OFFSET,      float,              PV_CHANNELS, VOLATILE) \
+    X(quantile0Pv,          QUANTILE0_PV0_OFFSET,       float,              PV_CHANNELS, VOLATILE) \
+    X(quantile1Pv,          QUANTILE1_PV0_OFFSET,       float,              PV_CHANNELS, VOLATILE) \
+    X(quantile2Pv,          QUANTILE2_PV0_OFFSET,       float,              PV_CHANNELS, VOLATILE) \
+    /* ### READ ONLY VALUES ### */ \
+    X(status,               STATUS_OFFSET,              uint64_t,           1,  READ_ONLY) \
+    X(error,                ERROR_OFFSET,               uint64_t,           1,  READ_ONLY) \
+    X(uid,                  UID_OFFSET,                 uint64_t,           1,  READ_ONLY) \
+    /* alarms raised since last read, see ALARM_MASK_* */ \
+    X(alarm,                ALARM_OFFSET,               uint64_t,           1,  READ_ONLY) \
+    /* actual cycle time of measurement loop in microseconds */ \
+    X(netCycleTimeUs,       OFFSET_NET_CYCLE_TIME,      uint32_t,           1,  READ_ONLY) \
+    /* number of samples taken since boot, wraps around */ \
+    X(sampleCounter,        SAMPLE_COUNTER_OFFSET,      uint32_t,           1,  READ_ONLY) \
+    /* time_us_64() when the last sample was taken */ \
+    X(captureTimeUs,        CAPTURE_TIME_US_OFFSET,     uint64_t,           1,  READ_ONLY) \
+    /* message string, holds messages (debug, info, warning, error) */ \
+    X(message,              MESSAGE_OFFSET,             char,               REGISTER_SIZE - MESSAGE_OFFSET, READ_ONLY)
+
+
+/**
+ * @brief Accessors of single channels of the per process value fields
+ *
+ * X(array, stride, ch0, ch1, ch2, ch3) - chN points to element N * stride of the
+ * array field of XERXES_REGISTER_MAP, stride is the number of elements per channel.
+ */
+#define XERXES_REGISTER_CHANNELS(X) \
+    X(gainPv,          1,  gainPv0, gainPv1, gainPv2, gainPv3) \
+    X(offsetPv,        1,  offsetPv0, offsetPv1, offsetPv2, offsetPv3) \
+    X(filterTypePv,    1,  filterTypePv0, filterTypePv1, filterTypePv2, filterTypePv3) \
+    X(filterAlphaPv,   1,  filterAlphaPv0, filterAlphaPv1, filterAlphaPv2, filterAlphaPv3) \
+    X(filterBiquadPv,  5,  filterBiquadPv0, filterBiquadPv1, filterBiquadPv2, filterBiquadPv3) \
+    X(deadbandPv,      1,  deadbandPv0, deadbandPv1, deadbandPv2, deadbandPv3) \
+    X(alarmHighPv,     1,  alarmHighPv0, alarmHighPv1, alarmHighPv2, alarmHighPv3) \
+    X(alarmLowPv,      1,  alarmLowPv0, alarmLowPv1, alarmLowPv2, alarmLowPv3) \
+    X(alarmHystPv,     1,  alarmHystPv0, alarmHystPv1, alarmHystPv2, alarmHystPv3) \
+    X(pv,              1,  pv0, pv1, pv2, pv3) \
+    X(meanPv,          1,  meanPv0, meanPv1, meanPv2, meanPv3) \
+    X(stdDevPv,        1,  stdDevPv0, stdDevPv1, stdDevPv2, stdDevPv3) \
+    X(minPv,           1,  minPv0, minPv1, minPv2, minPv3) \
+    X(maxPv,           1,  maxPv0, maxPv1, maxPv2, maxPv3) \
+    X(dv,              1,  dv0, dv1, dv2, dv3) \
+    X(av,              1,  av0, av1, av2, av3) \
+    X(mean10sPv,       1,  mean10sPv0, mean10sPv1, mean10sPv2, mean10sPv3) \
+    X(stdDev10sPv,     1,  stdDev10sPv0, stdDev10sPv1, stdDev10sPv2, stdDev10sPv3) \
+    X(mean60sPv,       1,  mean60sPv0, mean60sPv1, mean60sPv2, mean60sPv3) \
+    X(stdDev60sPv,     1,  stdDev60sPv0, stdDev60sPv1, stdDev60sPv2, stdDev60sPv3) \
+    X(quantile0Pv,     1,  quantile0Pv0, quantile0Pv1, quantile0Pv2, quantile0Pv3) \
+    X(quantile1Pv,     1,  quantile1Pv0, quantile1Pv1, quantile1Pv2, quantile1Pv3) \
+    X(quantile2Pv,     1,  quantile2Pv0, quantile2Pv1, quantile2Pv2, quantile2Pv3)
+
+
+/// @brief Access class of a register field, given by the memory range it lives in
+enum class RegisterAccess : uint8_t
+{
+    NV,         ///< non volatile, writable, stored in flash
+    VOLATILE,   ///< writable, lost on reset
+    READ_ONLY,  ///< written by the device only
+};
+
+
+/**
+ * @brief Descriptor of one register field
+ */
+struct RegisterField
+{
+    const char* name;
+    uint16_t offset;
+    /// @brief size of the field in bytes
+    uint16_t width;
+    /// @brief required alignment of the field in bytes
+    uint16_t align;
+    RegisterAccess access;
+};
+
+
+#define XERXES_REGISTER_FIELD(name, offset, type, count, access) \
+    RegisterField{#name, (offset), sizeof(type) * (count), alignof(type), RegisterAccess::access},
+
+/// @brief descriptors of all register fields
+constexpr RegisterField registerFields[] = {
+    XERXES_REGISTER_MAP(XERXES_REGISTER_FIELD)
+};
+
+#undef XERXES_REGISTER_FIELD
+
+
+/**
+ * @brief Access class of the memory range the byte belongs to
+ *
+ * @param offset offset of the byte in the register
+ * @return constexpr RegisterAccess access class of the range
+ */
+constexpr RegisterAccess rangeAccess(const uint16_t offset)
+{
+    if(offset < VOLATILE_OFFSET) return RegisterAccess::NV;
+    if(offset < READ_ONLY_OFFSET) return RegisterAccess::VOLATILE;
+    return RegisterAccess::READ_ONLY;
+}
+
+
+/// @brief true if every field is aligned to its type
+constexpr bool registerFieldsAligned()
+{
+    for(const auto &field : registerFields)
+    {
+        if(field.offset % field.align) return false;
+    }
+    return true;
+}
+
+
+/// @brief true if every field lies inside the register and inside the range of its access class
+constexpr bool registerFieldsInRange()
+{
+    for(const auto &field : registerFields)
+    {
+        const uint32_t last = field.offset + field.width - 1;
+        if(last >= REGISTER_SIZE) return false;
+        if(rangeAccess(field.offset) != field.access || rangeAccess(last) != field.access) return false;
+    }
+    return true;
+}
+
+
+/// @brief true if no two fields share a byte
+constexpr bool registerFieldsDisjoint()
+{
+    for(const auto &a : registerFields)
+    {
+        for(const auto &b : registerFields)
+        {
+            if(&a != &b && a.offset < b.offset + b.width && b.offset < a.offset + a.width) return false;
+        }
+    }
+    return true;
+}
+
+
+static_assert(registerFieldsAligned(), "register field is not aligned to its type");
+static_assert(registerFieldsInRange(), "register field crosses the range of its access class");
+static_assert(registerFieldsDisjoint(), "register fields overlap");
+
+
+/**
+ * @brief Access class of every byte of the register, built from the field descriptors
+ *
+ * Bytes which do not belong to any field take the access class of their range.
+ */
+constexpr std::array<RegisterAccess, REGISTER_SIZE> registerAccessMap = []()
+{
+    std::array<RegisterAccess, REGISTER_SIZE> map {};
+
+    for(uint16_t i=0; i<REGISTER_SIZE; i++)
+    {
+        map[i] = rangeAccess(i);
+    }
+
+    for(const auto &field : registerFields)
+    {
+        for(uint16_t i=field.offset; i<field.offset + field.width; i++)
+        {
+            map[i] = field.access;
+        }
+    }
+
+    return map;
+}();
+
+
+/**
+ * @brief Check if the master may write the given range of the register
+ *
+ * @param offset first byte of the write
+ * @param len number of bytes written
+ * @return true if the range lies in the register and contains no read only byte
+ */
+constexpr bool isWritable(const uint32_t offset, const uint32_t len)
+{
+    if(offset + len > REGISTER_SIZE)
+    {
+        return false;
+    }
+
+    for(uint32_t i=offset; i<offset + len; i++)
+    {
+        if(registerAccessMap[i] == RegisterAccess::READ_ONLY) return false;
+    }
+    return true;
+}
+
+
+/**
+ * @brief Check if the given range of the register contains non volatile bytes
+ *
+ * @param offset first byte of the range
+ * @param len number of bytes in the range
+ * @return true if any byte in the range is stored in flash
+ */
+constexpr bool touchesNonVolatile(const uint32_t offset, const uint32_t len)
+{
+    for(uint32_t i=offset; i<offset + len && i<REGISTER_SIZE; i++)
+    {
+        if(registerAccessMap[i] == RegisterAccess::NV) return true;
+    }
+    return false;
+}
+
+
+} // namespace Xerxes
+
+#endif // !__REGISTER_MAP_HPP
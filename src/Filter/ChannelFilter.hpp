@@ -0,0 +1,174 @@
+#ifndef CHANNEL_FILTER_HPP
+#define CHANNEL_FILTER_HPP
+
+#include <cstdint>
+#include <type_traits>
+
+namespace Xerxes
+{
+
+
+/// @brief filter applied to the samples of one channel, stored in non-volatile register
+enum FilterType : uint8_t
+{
+    FILTER_NONE     = 0,    ///< samples pass through
+    FILTER_EMA      = 1,    ///< exponential moving average, y += alpha * (x - y)
+    FILTER_BIQUAD   = 2,    ///< second order IIR, direct form I
+};
+
+
+/// @brief fractional bits of EMA alpha, 1 << EMA_ALPHA_FRAC_BITS = 1.0
+constexpr uint8_t EMA_ALPHA_FRAC_BITS = 16;
+
+/// @brief fractional bits of biquad coefficients, range is +-8
+constexpr uint8_t BIQUAD_FRAC_BITS = 28;
+
+/// @brief number of biquad coefficients: b0, b1, b2, a1, a2 (a0 is normalized to 1)
+constexpr uint8_t BIQUAD_COEFFS = 5;
+
+
+/**
+ * @brief Filter stage of one channel, configured by fixed point coefficients
+ *
+ * Coefficients are given on every call, so a change of the configuration
+ * registers takes effect immediately. When the filter type changes, the
+ * state is primed with the current sample to avoid a step response.
+ *
+ * Integer samples are filtered in fixed point, the EMA state keeps
+ * EMA_ALPHA_FRAC_BITS fractional bits so small alphas do not stall. Floating
+ * point samples convert the coefficients and filter in float.
+ *
+ * @note integer samples must fit into 24 bits (|x| < 2^24).
+ *
+ * @tparam T - type of the samples
+ */
+template <class T>
+class ChannelFilter
+{
+private:
+    /// @brief integer EMA state in fixed point, floating point state as is
+    typedef std::conditional_t<std::is_integral_v<T>, int64_t, T> state_t;
+
+    uint8_t type {FILTER_NONE};
+
+    /// @brief EMA output, or previous biquad outputs
+    state_t y1 {0};
+    state_t y2 {0};
+    /// @brief previous biquad inputs
+    T x1 {0};
+    T x2 {0};
+
+    /// @brief set state as if x was the input forever
+    void prime(const T x);
+
+    T ema(const T x, const uint32_t alphaQ);
+    T biquad(const T x, const int32_t* coeffsQ);
+
+public:
+    /**
+     * @brief Filter one sample
+     *
+     * @param x new sample
+     * @param type filter type, see FilterType
+     * @param alphaQ EMA alpha with EMA_ALPHA_FRAC_BITS fractional bits
+     * @param coeffsQ BIQUAD_COEFFS coefficients b0, b1, b2, a1, a2 with BIQUAD_FRAC_BITS fractional bits
+     * @return T filtered sample
+     */
+    T apply(const T x, const uint8_t type, const uint32_t alphaQ, const int32_t* coeffsQ);
+};
+
+
+template <class T>
+void ChannelFilter<T>::prime(const T x)
+{
+    if constexpr (std::is_integral_v<T>)
+    {
+        // EMA state holds fractional bits, biquad state holds samples
+        y1 = type == FILTER_EMA ? static_cast<int64_t>(x) << EMA_ALPHA_FRAC_BITS : x;
+    }
+    else
+    {
+        y1 = x;
+    }
+    y2 = y1;
+    x1 = x;
+    x2 = x;
+}
+
+
+template <class T>
+T ChannelFilter<T>::ema(const T x, const uint32_t alphaQ)
+{
+    if constexpr (std::is_integral_v<T>)
+    {
+        const int64_t xQ = static_cast<int64_t>(x) << EMA_ALPHA_FRAC_BITS;
+        y1 += ((xQ - y1) * alphaQ) >> EMA_ALPHA_FRAC_BITS;
+
+        // round to nearest
+        return static_cast<T>((y1 + (1 << (EMA_ALPHA_FRAC_BITS - 1))) >> EMA_ALPHA_FRAC_BITS);
+    }
+    else
+    {
+        constexpr T qToFloat = T(1) / (1 << EMA_ALPHA_FRAC_BITS);
+
+        y1 += (x - y1) * (alphaQ * qToFloat);
+        return y1;
+    }
+}
+
+
+template <class T>
+T ChannelFilter<T>::biquad(const T x, const int32_t* coeffsQ)
+{
+    const int32_t &b0 = coeffsQ[0], &b1 = coeffsQ[1], &b2 = coeffsQ[2];
+    const int32_t &a1 = coeffsQ[3], &a2 = coeffsQ[4];
+
+    state_t y;
+    if constexpr (std::is_integral_v<T>)
+    {
+        const int64_t acc = static_cast<int64_t>(b0) * x + static_cast<int64_t>(b1) * x1 + static_cast<int64_t>(b2) * x2
+            - static_cast<int64_t>(a1) * y1 - static_cast<int64_t>(a2) * y2;
+
+        // round to nearest
+        y = (acc + (1 << (BIQUAD_FRAC_BITS - 1))) >> BIQUAD_FRAC_BITS;
+    }
+    else
+    {
+        constexpr T qToFloat = T(1) / (1 << BIQUAD_FRAC_BITS);
+
+        y = (b0 * x + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2) * qToFloat;
+    }
+
+    x2 = x1;
+    x1 = x;
+    y2 = y1;
+    y1 = y;
+
+    return static_cast<T>(y);
+}
+
+
+template <class T>
+T ChannelFilter<T>::apply(const T x, const uint8_t type, const uint32_t alphaQ, const int32_t* coeffsQ)
+{
+    if(type != this->type)
+    {
+        this->type = type;
+        prime(x);
+    }
+
+    switch (type)
+    {
+    case FILTER_EMA:
+        return ema(x, alphaQ);
+    case FILTER_BIQUAD:
+        return biquad(x, coeffsQ);
+    default:
+        return x;
+    }
+}
+
+
+} // namespace Xerxes
+
+#endif // !CHANNEL_FILTER_HPP
@@ -27,7 +27,8 @@ extern "C"
     
 #define EXT_3V3_EN_PIN      6
     
-#define RS_EN_PIN           19
+#define RS_EN_PIN           19  // shutdown of the auto-direction transceiver, high = enabled
+// #define RS_DE_PIN                // driver enable of transceivers without automatic direction control
 #define RS_TX_PIN           UART0_TX_PIN
 #define RS_RX_PIN           UART0_RX_PIN
 
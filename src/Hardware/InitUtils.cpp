@@ -7,6 +7,9 @@
 #include "UserFlash.hpp"
 #include "Core/Definitions.h"
 #include "Core/Register.hpp"
+#include "Filter/ChannelFilter.hpp"
+#include "Communication/DmaRxRing.hpp"
+#include "Communication/DmaTx.hpp"
 
 #include "pico/stdlib.h"
 #include "hardware/uart.h"
@@ -15,45 +18,17 @@
 #include "hardware/irq.h"
 #include "hardware/flash.h"
 #include "hardware/rtc.h"
-#include "pico/util/queue.h"
 
 
 extern Xerxes::Register _reg;
-extern queue_t txFifo, rxFifo;
-
-
-void userInitQueue()
-{
-    queue_init(&txFifo, 1, RX_TX_QUEUE_SIZE);
-    queue_init(&rxFifo, 1, RX_TX_QUEUE_SIZE);
-}
-
-
-void uart_interrupt_handler()
-{
-    gpio_put(USR_LED_PIN, 1);
-
-    if(uart_is_readable(uart0))
-    {
-        unsigned char rcvd = uart_getc(uart0);
-        auto success = queue_try_add(&rxFifo, &rcvd);
-
-        if(!success)
-        {
-            // set cpu overload flag
-            *_reg.error |= ERROR_MASK_CPU_OVERLOAD;
-        }
-    }
-
-    gpio_put(USR_LED_PIN, 0);
-    irq_clear(UART0_IRQ);
-}
+extern Xerxes::DmaRxRing rxRing;
+extern Xerxes::DmaTx txDma;
 
 
 void userInitUart()
 {
-    // Initialise UART 0 on 115200baud
-    uart_init(uart0, DEFAULT_BAUDRATE);
+    // Initialise UART 0 on the configured baud rate
+    uart_init(uart0, userBaudrate());
  
     // Set the GPIO pin mux to the UART - 16 is TX, 17 is RX
     gpio_set_function(RS_TX_PIN, GPIO_FUNC_UART);
@@ -70,13 +45,52 @@ void userInitUart()
     // disable stdio uart
     // stdio_set_driver_enabled(&stdio_uart, false);
 
-    // set uart interrupt handler, must be done before enabling uart interrupt
-    irq_set_exclusive_handler(UART0_IRQ, uart_interrupt_handler);
-    // enable uart interrupt
-    irq_set_enabled(UART0_IRQ, true);
+    #ifdef RS_DE_PIN
+    // transceiver without automatic direction control, listen until there is something to send
+    gpio_init(RS_DE_PIN);
+    gpio_set_dir(RS_DE_PIN, GPIO_OUT);
+    gpio_put(RS_DE_PIN, false);
+    #endif // RS_DE_PIN
+
+    // received bytes are copied to the rx ring by DMA, no interrupt per byte
+    rxRing.start(uart0);
+    // frames are sent by DMA, core0 does not wait for them
+    txDma.start(uart0);
+}
+
+
+uint32_t userBaudrate()
+{
+    const uint32_t baudrate = *_reg.baudRate();
 
-    // enable uart interrupt for receiving and transmitting
-    uart_set_irq_enables(uart0, true, false);
+    // register is blank after update from older firmware or corrupted, use the default
+    if(baudrate < BAUD_RATE_MIN || baudrate > BAUD_RATE_MAX)
+    {
+        return DEFAULT_BAUDRATE;
+    }
+
+    return baudrate;
+}
+
+
+uint32_t userBaudFallbackUs()
+{
+    const uint32_t timeoutUs = *_reg.baudFallbackUs();
+
+    // register is blank after update from older firmware or corrupted, use the default
+    if(timeoutUs < BAUD_FALLBACK_MIN_US || timeoutUs > BAUD_FALLBACK_MAX_US)
+    {
+        return BAUD_FALLBACK_TIMEOUT_US;
+    }
+
+    return timeoutUs;
+}
+
+
+void userSetBaudrate(const uint32_t baudrate)
+{
+    uart_set_baudrate(uart0, baudrate);
+    rxRing.clear();
 }
 
 
@@ -106,13 +120,29 @@ void userLoadDefaultValues()
         _reg.memTable[i] = 0;
     }
 
-    *_reg.gainPv0    = 1;
-    *_reg.gainPv1    = 1;    
-    *_reg.gainPv2    = 1;
-    *_reg.gainPv3    = 1;
-
-    *_reg.desiredCycleTimeUs = DEFAULT_CYCLE_TIME_US; 
-    _reg.config->all = 0;
+    *_reg.gainPv0()    = 1;
+    *_reg.gainPv1()    = 1;    
+    *_reg.gainPv2()    = 1;
+    *_reg.gainPv3()    = 1;
+
+    // filters are off, their coefficients pass samples through when enabled
+    *_reg.filterAlphaPv0() = 1 << Xerxes::EMA_ALPHA_FRAC_BITS;
+    *_reg.filterAlphaPv1() = 1 << Xerxes::EMA_ALPHA_FRAC_BITS;
+    *_reg.filterAlphaPv2() = 1 << Xerxes::EMA_ALPHA_FRAC_BITS;
+    *_reg.filterAlphaPv3() = 1 << Xerxes::EMA_ALPHA_FRAC_BITS;
+
+    _reg.filterBiquadPv0()[0] = 1 << Xerxes::BIQUAD_FRAC_BITS;
+    _reg.filterBiquadPv1()[0] = 1 << Xerxes::BIQUAD_FRAC_BITS;
+    _reg.filterBiquadPv2()[0] = 1 << Xerxes::BIQUAD_FRAC_BITS;
+    _reg.filterBiquadPv3()[0] = 1 << Xerxes::BIQUAD_FRAC_BITS;
+
+    *_reg.desiredCycleTimeUs() = DEFAULT_CYCLE_TIME_US; 
+    *_reg.baudRate() = DEFAULT_BAUDRATE;
+    *_reg.baudFallbackUs() = BAUD_FALLBACK_TIMEOUT_US;
+    _reg.quantileP()[0] = QUANTILE_P0;
+    _reg.quantileP()[1] = QUANTILE_P1;
+    _reg.quantileP()[2] = QUANTILE_P2;
+    _reg.config()->all = 0;
     updateFlash((uint8_t *)_reg.memTable);
 }
 
@@ -125,9 +155,6 @@ void userInit()
     // initialize the gpios
     userInitGpio();
 
-    // initialize the queues for uart communication
-    userInitQueue();
-
     // initialize the flash memory and load the default values
     if(!userInitFlash((uint8_t *)_reg.memTable))
     {
@@ -5,25 +5,37 @@
 
 
 /**
- * @brief Initialize the queues for the UART
+ * @brief Initialize the UART
+ * 
+ * This function initializes the UART and starts the DMA receiving into `rxRing`. A RS485 transceiver is also initialized
  */
-void userInitQueue();
+void userInitUart(void);
 
 
 /**
- * @brief Interrupt handler for the UART
+ * @brief Baud rate configured in the register
  * 
- * This function is called when the UART receives a byte. The byte is received and then pushed to txFifo
+ * @return uint32_t baud rate register, DEFAULT_BAUDRATE if it is out of range
  */
-void uart_interrupt_handler();
+uint32_t userBaudrate();
 
 
 /**
- * @brief Initialize the UART
+ * @brief Time without a valid frame after which an unconfirmed baud rate is given up
  * 
- * This function initializes the UART and sets the interrupt handler `uart_interrupt_handler`. A RS485 transceiver is also initialized
+ * @return uint32_t baud fallback register in us, BAUD_FALLBACK_TIMEOUT_US if it is out of range
  */
-void userInitUart(void);
+uint32_t userBaudFallbackUs();
+
+
+/**
+ * @brief Change the baud rate of the running UART
+ * 
+ * Bytes received so far are dropped, they may be garbled by the change.
+ * 
+ * @param baudrate new baud rate, the UART must not be transmitting
+ */
+void userSetBaudrate(const uint32_t baudrate);
 
 
 /**
@@ -51,7 +63,7 @@ void userLoadDefaultValues();
 /**
  * @brief Initialize the micro-controller using the Pico SDK.
  * 
- * This function initializes the clocks, GPIO pins, UART, flash memory and queues, if necessary it also loads the default values
+ * This function initializes the clocks, GPIO pins, UART and flash memory, if necessary it also loads the default values
  * 
  */
 void userInit();
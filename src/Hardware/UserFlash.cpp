@@ -38,21 +38,31 @@ bool userInitFlash(uint8_t *memTable)
 }
 
 
-void updateFlash(const uint8_t *memTable)
+bool updateFlash(const uint8_t *memTable)
 {
-    // disable interrupts first
-    auto status = save_and_disable_interrupts();
+    const uint8_t *flash_target_contents = (const uint8_t *) (XIP_BASE + FLASH_TARGET_OFFSET); // Flash memory contents
 
-    // erase flash, must be done in sector size, 4KB, it takes 49ms    
-    flash_range_erase(FLASH_TARGET_OFFSET, VOLATILE_OFFSET);
+    // nothing to do if flash already holds the same values, saves an erase cycle
+    if(std::memcmp(flash_target_contents, memTable, VOLATILE_OFFSET) == 0)
+    {
+        return false;
+    }
 
     // copy memory to buffer
     uint8_t memImage[VOLATILE_OFFSET];
     std::memcpy(memImage, (uint8_t *)memTable, sizeof(memImage));
 
+    // disable interrupts first
+    auto status = save_and_disable_interrupts();
+
+    // erase flash, must be done in sector size, 4KB, it takes 49ms    
+    flash_range_erase(FLASH_TARGET_OFFSET, FLASH_SECTOR_SIZE);
+
     // write flash, must be done in page size (256bytes), approx 400us
     flash_range_program(FLASH_TARGET_OFFSET, memImage, VOLATILE_OFFSET);
 
     // finally, restore interrupts
     restore_interrupts(status);
+
+    return true;
 }
\ No newline at end of file
@@ -15,8 +15,15 @@ bool userInitFlash(uint8_t *memTable);
 /**
  * @brief Update flash with current memory contents
  * 
+ * Non-volatile range is compared with flash first, the sector is erased and
+ * programmed only if it differs.
+ * 
+ * @return true if flash was written
+ * @return false if flash already holds the same values
+ * 
+ * @note other core must not execute from flash while it is written.
  */
-void updateFlash(const uint8_t *memTable);
+bool updateFlash(const uint8_t *memTable);
 
 
 #endif // !__USER_FLASH_HPP
\ No newline at end of file
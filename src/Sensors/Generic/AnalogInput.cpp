@@ -31,6 +31,7 @@ void AnalogInput::init(uint8_t numChannels, uint8_t oversampleBits)
     this->overSample = 1 << (2 * oversampleBits);
     this->effectiveBitDepth = rpBitDepth + oversampleBits;
     this->numCounts = 1 << effectiveBitDepth;
+    this->countsToUnit = 1.0f / numCounts;
 
     // init ADC
     adc_init();
@@ -42,7 +43,7 @@ void AnalogInput::init(uint8_t numChannels, uint8_t oversampleBits)
     adc_gpio_init(ADC3_PIN);
 
     // set update rate
-    *_reg->desiredCycleTimeUs = _updateRateUs;
+    *_reg->desiredCycleTimeUs() = _updateRateUs;
 
     // update sensor values
     this->update();
@@ -69,72 +70,15 @@ void AnalogInput::update()
         results[channel] >>= oversampleExtraBits;
     }
     
-    // convert to value on scale <0, 1)
-    // optimization: use if-else instead of switch, since numChannels is known at compile time
-    if(numChannels == 1)
-    {
-        *_reg->pv0 = results[0] / static_cast<double>(numCounts);
-    }
-    else if(numChannels == 2)
-    {
-        *_reg->pv0 = results[0] / static_cast<double>(numCounts);
-        *_reg->pv1 = results[1] / static_cast<double>(numCounts);
-    }
-    else if(numChannels == 3)
-    {
-        *_reg->pv0 = results[0] / static_cast<double>(numCounts);
-        *_reg->pv1 = results[1] / static_cast<double>(numCounts);
-        *_reg->pv2 = results[2] / static_cast<double>(numCounts);
-    }
-    else if(numChannels == 4)
-    {
-        *_reg->pv0 = results[0] / static_cast<double>(numCounts);
-        *_reg->pv1 = results[1] / static_cast<double>(numCounts);
-        *_reg->pv2 = results[2] / static_cast<double>(numCounts);
-        *_reg->pv3 = results[3] / static_cast<double>(numCounts);
-    }
-    else
-    {
-        // do nothing
-    }
-
-
-    // if calcStat is true, update statistics
-    if(_reg->config->bits.calcStat)
-    {
-        // insert new values into ring buffer
-        rbpv0.insertOne(*_reg->pv0);
-
-        // update statistics
-        rbpv0.updateStatistics();
-
-        // update min, max stddev etc...
-        rbpv0.getStatistics(_reg->minPv0, _reg->maxPv0, _reg->meanPv0, _reg->stdDevPv0);
-    }
-
-    // if calcStat is true and numChannels > 1, update statistics for pv1
-    if(_reg->config->bits.calcStat && numChannels > 1)
-    {
-        rbpv1.insertOne(*_reg->pv1);
-        rbpv1.updateStatistics();
-        rbpv1.getStatistics(_reg->minPv1, _reg->maxPv1, _reg->meanPv1, _reg->stdDevPv1);
-    }
-
-    // if calcStat is true and numChannels > 2, update statistics for pv2
-    if(_reg->config->bits.calcStat && numChannels > 2)
-    {
-        rbpv2.insertOne(*_reg->pv2);
-        rbpv2.updateStatistics();
-        rbpv2.getStatistics(_reg->minPv2, _reg->maxPv2, _reg->meanPv2, _reg->stdDevPv2);
-    }
-
-    // if calcStat is true and numChannels > 3, update statistics for pv3
-    if(_reg->config->bits.calcStat && numChannels > 3)
-    {
-        rbpv3.insertOne(*_reg->pv3);
-        rbpv3.updateStatistics();
-        rbpv3.getStatistics(_reg->minPv3, _reg->maxPv3, _reg->meanPv3, _reg->stdDevPv3);
-    }
+    // raw counts are filtered and converted to value on scale <0, 1), unused channels are masked out
+    const int32_t counts[numProcessValues] = {
+        static_cast<int32_t>(results[0]),
+        static_cast<int32_t>(results[1]),
+        static_cast<int32_t>(results[2]),
+        static_cast<int32_t>(results[3])
+    };
+
+    processSamples(counts, (1 << numChannels) - 1, countsToUnit);
 }
 
 
@@ -150,10 +94,10 @@ std::string AnalogInput::getJsonLast()
     stringstream ss;
 
     ss << endl << "  {" << endl;
-    ss << "    \"AI0\": " << *this->_reg->pv0 << "," << endl;
-    ss << "    \"AI1\": " << *this->_reg->pv1 << "," << endl;
-    ss << "    \"AI2\": " << *this->_reg->pv2 << "," << endl;
-    ss << "    \"AI3\": " << *this->_reg->pv3 << endl;    
+    ss << "    \"AI0\": " << *this->_reg->pv0() << "," << endl;
+    ss << "    \"AI1\": " << *this->_reg->pv1() << "," << endl;
+    ss << "    \"AI2\": " << *this->_reg->pv2() << "," << endl;
+    ss << "    \"AI3\": " << *this->_reg->pv3() << endl;    
     ss << "  }";
 
     return ss.str();
@@ -166,10 +110,10 @@ std::string AnalogInput::getJsonMin()
     stringstream ss;
 
     ss << endl << "  {" << endl;
-    ss << "    \"Min(AI0)\": " << *this->_reg->minPv0 << "," << endl;
-    ss << "    \"Min(AI1)\": " << *this->_reg->minPv1 << "," << endl;
-    ss << "    \"Min(AI2)\": " << *this->_reg->minPv2 << "," << endl;
-    ss << "    \"Min(AI3)\": " << *this->_reg->minPv3 << endl;    
+    ss << "    \"Min(AI0)\": " << *this->_reg->minPv0() << "," << endl;
+    ss << "    \"Min(AI1)\": " << *this->_reg->minPv1() << "," << endl;
+    ss << "    \"Min(AI2)\": " << *this->_reg->minPv2() << "," << endl;
+    ss << "    \"Min(AI3)\": " << *this->_reg->minPv3() << endl;    
     ss << "  }";
 
     return ss.str();
@@ -182,10 +126,10 @@ std::string AnalogInput::getJsonMax()
     stringstream ss;
 
     ss << endl << "  {" << endl;
-    ss << "    \"Max(AI0)\": " << *this->_reg->maxPv0 << "," << endl;
-    ss << "    \"Max(AI1)\": " << *this->_reg->maxPv1 << "," << endl;
-    ss << "    \"Max(AI2)\": " << *this->_reg->maxPv2 << "," << endl;
-    ss << "    \"Max(AI3)\": " << *this->_reg->maxPv3 << endl;    
+    ss << "    \"Max(AI0)\": " << *this->_reg->maxPv0() << "," << endl;
+    ss << "    \"Max(AI1)\": " << *this->_reg->maxPv1() << "," << endl;
+    ss << "    \"Max(AI2)\": " << *this->_reg->maxPv2() << "," << endl;
+    ss << "    \"Max(AI3)\": " << *this->_reg->maxPv3() << endl;    
     ss << "  }";
 
     return ss.str();
@@ -198,10 +142,10 @@ std::string AnalogInput::getJsonMean()
     stringstream ss;
 
     ss << endl << "  {" << endl;
-    ss << "    \"Mean(AI0)\": " << *this->_reg->meanPv0 << "," << endl;
-    ss << "    \"Mean(AI1)\": " << *this->_reg->meanPv1 << "," << endl;
-    ss << "    \"Mean(AI2)\": " << *this->_reg->meanPv2 << "," << endl;
-    ss << "    \"Mean(AI3)\": " << *this->_reg->meanPv3 << endl;    
+    ss << "    \"Mean(AI0)\": " << *this->_reg->meanPv0() << "," << endl;
+    ss << "    \"Mean(AI1)\": " << *this->_reg->meanPv1() << "," << endl;
+    ss << "    \"Mean(AI2)\": " << *this->_reg->meanPv2() << "," << endl;
+    ss << "    \"Mean(AI3)\": " << *this->_reg->meanPv3() << endl;    
     ss << "  }";
 
     return ss.str();
@@ -214,10 +158,10 @@ std::string AnalogInput::getJsonStdDev()
     stringstream ss;
 
     ss << endl << "  {" << endl;
-    ss << "    \"StdDev(AI0)\": " << *this->_reg->stdDevPv0 << "," << endl;
-    ss << "    \"StdDev(AI1)\": " << *this->_reg->stdDevPv1 << "," << endl;
-    ss << "    \"StdDev(AI2)\": " << *this->_reg->stdDevPv2 << "," << endl;
-    ss << "    \"StdDev(AI3)\": " << *this->_reg->stdDevPv3 << endl;
+    ss << "    \"StdDev(AI0)\": " << *this->_reg->stdDevPv0() << "," << endl;
+    ss << "    \"StdDev(AI1)\": " << *this->_reg->stdDevPv1() << "," << endl;
+    ss << "    \"StdDev(AI2)\": " << *this->_reg->stdDevPv2() << "," << endl;
+    ss << "    \"StdDev(AI3)\": " << *this->_reg->stdDevPv3() << endl;
     ss << "  }";
 
     return ss.str();
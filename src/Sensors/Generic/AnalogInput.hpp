@@ -23,8 +23,9 @@ constexpr uint8_t rpBitDepth                = 12;
  * @note default ADC depth on RP2040 is 12 bit, 8.7 ENOB (approx. 54dB SNR)
  * @note AnalogInput uses oversampling to increase resolution, increasing SNR by 6dB per bit
  * @note n-bit oversampling increases sampling time too: sample time = 4^n * conversion time 
+ * @note statistics are calculated from raw counts in fixed point, scaled to <0, 1) when published
  */
-class AnalogInput : public Sensor
+class AnalogInput : public Sensor<defaultStatBufferLen, int32_t>
 {
 private:
     uint64_t results[4] = {0, 0, 0, 0};  // up to 4 channels, 64 bit to avoid overflow
@@ -33,6 +34,7 @@ private:
     uint16_t overSample             = 1 << (2 * defaultOversampleBits);   // oversampling factor, 4^4 = 256
     uint8_t effectiveBitDepth       = rpBitDepth + defaultOversampleBits;   // effective bit depth, 12 + 4 = 16
     uint64_t numCounts              = 1 << effectiveBitDepth;           // number of counts, 2^16 = 65536
+    float countsToUnit              = 1.0f / numCounts;                 // conversion from counts to scale <0, 1)
     uint8_t numChannels             = 4;                                // number of channels, default is 4
 
     constexpr static uint32_t _updateRateHz = 100;  // update frequency in Hz
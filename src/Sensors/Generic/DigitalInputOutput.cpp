@@ -26,20 +26,20 @@ void DigitalInputOutput::init(uint32_t iomask, uint32_t direction)
     this->used_iomask = iomask;
     
     // never use calcStat in this sensor
-    _reg->config->bits.calcStat = 0;
+    _reg->config()->bits.calcStat = 0;
     
     // Set the update rate
-    *_reg->desiredCycleTimeUs = _updateRateUs;
+    *_reg->desiredCycleTimeUs() = _updateRateUs;
 }
 
 
 void DigitalInputOutput::update()
 {
     // Set GPIOs to whatever the values are in the pointer dv0
-    gpio_put_masked(this->used_iomask, *_reg->dv0);
+    gpio_put_masked(this->used_iomask, *_reg->dv0());
     auto state = gpio_get_all();
     auto gpio_pins = state & used_iomask;
-    *_reg->dv1 = gpio_pins;
+    *_reg->dv1() = gpio_pins;
 }
 
 
@@ -56,8 +56,8 @@ std::string DigitalInputOutput::getJson()
     stringstream ss;
 
     ss << "{" << endl;
-    ss << "\t\"DO\": " << *_reg->dv0 << "," << endl;
-    ss << "\t\"DI\": " << *_reg->dv1 << endl;
+    ss << "\t\"DO\": " << *_reg->dv0() << "," << endl;
+    ss << "\t\"DI\": " << *_reg->dv1() << endl;
     ss << "}" << endl;
 
     return ss.str();
@@ -63,9 +63,7 @@ void HX711::init()
     _devid = DEVID_STRAIN_24BIT;
     
     // change sample rate to 10Hz
-    *_reg->desiredCycleTimeUs = _sensorUpdateRateUs;
-
-    rbpv0 = StatisticBuffer<float>(_sensorFreqHz);
+    *_reg->desiredCycleTimeUs() = _sensorUpdateRateUs;
 
     // turn on 3.3V supply
     gpio_init(EXT_3V3_EN_PIN);
@@ -82,21 +80,12 @@ void HX711::init()
 
 void HX711::update()
 {
-    // read hx711 adc
-    *_reg->pv0 = this->read();
-
-    // if calcStat is true, update statistics
-    if(_reg->config->bits.calcStat)
-    {
-        // insert new values into ring buffer
-        rbpv0.insertOne(*_reg->pv0);
+    // read hx711 adc, keep raw counts for statistics
+    const int32_t counts = this->read();
 
-        // update statistics
-        rbpv0.updateStatistics();
-
-        // update min, max stddev etc...
-        rbpv0.getStatistics(_reg->minPv0, _reg->maxPv0, _reg->meanPv0, _reg->stdDevPv0);
-    }
+    // only pv0 is used, raw counts are written to it after filtering
+    const int32_t samples[numProcessValues] = {counts, 0, 0, 0};
+    processSamples(samples, 0b0001);
 }
 
 
@@ -113,11 +102,11 @@ std::string HX711::getJson()
     stringstream ss;
 
     ss << endl << "{" << endl;
-    ss << "  \"Last\":" << *_reg->pv0 << "," << endl;
-    ss << "  \"Min\":" << *_reg->minPv0 << "," << endl;
-    ss << "  \"Max\":" << *_reg->maxPv0 << "," << endl;
-    ss << "  \"Mean\":" << *_reg->meanPv0 << "," << endl;
-    ss << "  \"StdDev\":" << *_reg->stdDevPv0 << endl;
+    ss << "  \"Last\":" << *_reg->pv0() << "," << endl;
+    ss << "  \"Min\":" << *_reg->minPv0() << "," << endl;
+    ss << "  \"Max\":" << *_reg->maxPv0() << "," << endl;
+    ss << "  \"Mean\":" << *_reg->meanPv0() << "," << endl;
+    ss << "  \"StdDev\":" << *_reg->stdDevPv0() << endl;
     
     ss << "}";
 
@@ -6,10 +6,16 @@
 namespace Xerxes
 {
 
+/// @brief HX711 sensor update frequency in Hz
+constexpr uint32_t hx711FreqHz = 80;
+
 /**
  * @brief HX711 ADC
+ * 
+ * Statistics window holds approx. 1 second of samples, statistics are 
+ * calculated from raw counts in fixed point
  */ 
-class HX711 : public Sensor
+class HX711 : public Sensor<ringBufferLen(hx711FreqHz), int32_t>
 {
 private:
     /// @brief convenience typedef
@@ -21,7 +27,7 @@ private:
     /// @brief set clock pin to high/low
     void clock(bool level);
 
-    constexpr static uint32_t _sensorFreqHz = 80;  // sensor update frequency in Hz
+    constexpr static uint32_t _sensorFreqHz = hx711FreqHz;  // sensor update frequency in Hz
     constexpr static uint32_t _sensorUpdateRateUs = _usInS / _sensorFreqHz;  // sensor update rate in microseconds
 
 public:
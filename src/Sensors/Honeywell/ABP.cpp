@@ -87,25 +87,12 @@ void ABP::update()
     p_val = (uint16_t)(((data[0] & 0b00111111)<<8) + data[1]);
     t_val = (uint16_t)(((data[2]<<8) + (data[3] & 0b11100000))>>5);
     
-    *_reg->pv0 = (float)((((p_val-VALmin)*(Pmax-Pmin))/(VALmax-VALmin)) + Pmin); 
-    *_reg->pv3 = (float)((t_val*200.0/2047.0)-50.0);     // calculate internal temperature
+    *_reg->pv0() = (float)((((p_val-VALmin)*(Pmax-Pmin))/(VALmax-VALmin)) + Pmin); 
+    *_reg->pv3() = (float)((t_val*200.0/2047.0)-50.0);     // calculate internal temperature
 
 
-    // if calcStat is true, update statistics
-    if(_reg->config->bits.calcStat)
-    {
-        // insert new values into ring buffer
-        rbpv0.insertOne(*_reg->pv0);
-        rbpv3.insertOne(*_reg->pv3);
-
-        // update statistics
-        rbpv0.updateStatistics();
-        rbpv3.updateStatistics();
-
-        // update min, max stddev etc...
-        rbpv0.getStatistics(_reg->minPv0, _reg->maxPv0, _reg->meanPv0, _reg->stdDevPv0);
-        rbpv3.getStatistics(_reg->minPv3, _reg->maxPv3, _reg->meanPv3, _reg->stdDevPv3);
-    }
+    // filter and update statistics of pressure (pv0) and temperature (pv3)
+    processSamples(0b1001);
 }
 
 
@@ -115,12 +102,12 @@ std::string ABP::getJson()
 
     // return values as JSON
     ss << "{" << std::endl;
-    ss << "\t\"p\": " << *_reg->pv0 << "," << std::endl;
-    ss << "\t\"Avg(t)\": " << *_reg->meanPv3 << "," << std::endl;
-    ss << "\t\"Avg(p)\": " << *_reg->meanPv0 << "," << std::endl;
-    ss << "\t\"StdDev(p)\": " << *_reg->stdDevPv0 << "," << std::endl;
-    ss << "\t\"Min(p)\": " << *_reg->minPv0 << "," << std::endl;
-    ss << "\t\"Max(p)\": " << *_reg->maxPv0 << std::endl;
+    ss << "\t\"p\": " << *_reg->pv0() << "," << std::endl;
+    ss << "\t\"Avg(t)\": " << *_reg->meanPv3() << "," << std::endl;
+    ss << "\t\"Avg(p)\": " << *_reg->meanPv0() << "," << std::endl;
+    ss << "\t\"StdDev(p)\": " << *_reg->stdDevPv0() << "," << std::endl;
+    ss << "\t\"Min(p)\": " << *_reg->minPv0() << "," << std::endl;
+    ss << "\t\"Max(p)\": " << *_reg->maxPv0() << std::endl;
     ss << "}";
 
     return ss.str();
@@ -15,7 +15,7 @@ constexpr float VALmax  = 14745.0;  // counts = 90% 2^14
 constexpr float Pmin    = 0.0;      // mbar    
 constexpr float Pmax    = 60.0;    // mbar, or: 611.8298 mm
 
-class ABP : public Sensor
+class ABP : public Sensor<>
 {
 protected:
     // typedef Sensor as super class for easier access
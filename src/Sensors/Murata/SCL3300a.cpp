@@ -43,12 +43,10 @@ void SCL3300a::init()
     _devid = DEVID_ACCEL_XYZ;
 
     // set cycle frequency to 70Hz
-    *_reg->desiredCycleTimeUs = 1000000 / sensor_freq_hz;  // 70Hz
+    *_reg->desiredCycleTimeUs() = 1000000 / sensor_freq_hz;  // 70Hz
 
-    rbpv0 = StatisticBuffer<float>(sensor_freq_hz);
-    rbpv1 = StatisticBuffer<float>(sensor_freq_hz);
-    rbpv2 = StatisticBuffer<float>(sensor_freq_hz);
-    rbpv3 = StatisticBuffer<float>(sensor_freq_hz);
+    // statistics window is sized at compile time, it must hold at least 1s of samples
+    static_assert(ringBufferLen(sensor_freq_hz) <= defaultStatBufferLen);
 
     constexpr uint spi_freq = 2 * MHZ;
     // init spi with freq , return actual frequency
@@ -103,42 +101,33 @@ void SCL3300a::update()
         this->needInit = true;
     }   
 
-    *_reg->pv0 = getAccFromPacket(packetX, CMD::Change_to_mode_2);
-    *_reg->pv1 = getAccFromPacket(packetY, CMD::Change_to_mode_2);
-    *_reg->pv2 = getAccFromPacket(packetZ, CMD::Change_to_mode_2);
+    *_reg->pv0() = getAccFromPacket(packetX, CMD::Change_to_mode_2);
+    *_reg->pv1() = getAccFromPacket(packetY, CMD::Change_to_mode_2);
+    *_reg->pv2() = getAccFromPacket(packetZ, CMD::Change_to_mode_2);
 
     // extract temperature from packet and convert to degrees
     uint16_t raw_temp = (uint16_t)(packetT->DATA_H << 8) + packetT->DATA_L;
-    *_reg->pv3 = -273 + (static_cast<float>(raw_temp) / 18.9);
+    *_reg->pv3() = -273 + (static_cast<float>(raw_temp) / 18.9);
 
-    // if calcStat is true, update statistics
-    if(_reg->config->bits.calcStat)
+    // filter and update statistics of all process values
+    processSamples(allProcessValues);
+}
+
+
+void SCL3300a::publishStatistics()
+{
+    SCL3X00::publishStatistics();
+
+    // amplitudes are derived from the statistics
+    if(_reg->config()->bits.calcStat)
     {
-        // insert new values into ring buffer
-        rbpv0.insertOne(*_reg->pv0);
-        rbpv1.insertOne(*_reg->pv1);
-        rbpv2.insertOne(*_reg->pv2);
-        rbpv3.insertOne(*_reg->pv3);
-
-        // update statistics
-        rbpv0.updateStatistics();
-        rbpv1.updateStatistics();
-        rbpv2.updateStatistics();
-        rbpv3.updateStatistics();
-
-        // update min, max stddev etc...
-        rbpv0.getStatistics(_reg->minPv0, _reg->maxPv0, _reg->meanPv0, _reg->stdDevPv0);
-        rbpv1.getStatistics(_reg->minPv1, _reg->maxPv1, _reg->meanPv1, _reg->stdDevPv1);
-        rbpv2.getStatistics(_reg->minPv2, _reg->maxPv2, _reg->meanPv2, _reg->stdDevPv2);
-        rbpv3.getStatistics(_reg->minPv3, _reg->maxPv3, _reg->meanPv3, _reg->stdDevPv3);
-        
-        *_reg->av0 = *_reg->stdDevPv0 * SQRT2;
-        *_reg->av1 = *_reg->stdDevPv1 * SQRT2;
-        *_reg->av2 = *_reg->stdDevPv2 * SQRT2;
+        *_reg->av0() = *_reg->stdDevPv0() * SQRT2;
+        *_reg->av1() = *_reg->stdDevPv1() * SQRT2;
+        *_reg->av2() = *_reg->stdDevPv2() * SQRT2;
         
         // calculate normal vector from 3 axis std dev
-        double normal_stdev = sqrt(pow(*_reg->stdDevPv0, 2) + pow(*_reg->stdDevPv1, 2) + pow(*_reg->stdDevPv2, 2));
-        *_reg->av3 = normal_stdev * SQRT2;
+        double normal_stdev = sqrt(pow(*_reg->stdDevPv0(), 2) + pow(*_reg->stdDevPv1(), 2) + pow(*_reg->stdDevPv2(), 2));
+        *_reg->av3() = normal_stdev * SQRT2;
     }
 }
 
@@ -183,10 +172,10 @@ std::string SCL3300a::getJsonAmplitude()
     stringstream ss;
 
     ss << endl << "  {" << endl;
-    ss << "    \"Amplitude(X)\": " << *this->_reg->av0 << "," << endl;
-    ss << "    \"Amplitude(Y)\": " << *this->_reg->av1 << "," << endl;
-    ss << "    \"Amplitude(Z)\": " << *this->_reg->av2 << "," << endl;
-    ss << "    \"Amplitude\": " << *this->_reg->av3 << endl;    
+    ss << "    \"Amplitude(X)\": " << *this->_reg->av0() << "," << endl;
+    ss << "    \"Amplitude(Y)\": " << *this->_reg->av1() << "," << endl;
+    ss << "    \"Amplitude(Z)\": " << *this->_reg->av2() << "," << endl;
+    ss << "    \"Amplitude\": " << *this->_reg->av3() << endl;    
     ss << "  }";
 
     return ss.str();
@@ -199,10 +188,10 @@ std::string SCL3300a::getJsonLast()
     stringstream ss;
 
     ss << endl << "  {" << endl;
-    ss << "    \"X\": " << *this->_reg->pv0 << "," << endl;
-    ss << "    \"Y\": " << *this->_reg->pv1 << "," << endl;
-    ss << "    \"Z\": " << *this->_reg->pv2 << "," << endl;
-    ss << "    \"t\": " << *this->_reg->pv3 << endl;    
+    ss << "    \"X\": " << *this->_reg->pv0() << "," << endl;
+    ss << "    \"Y\": " << *this->_reg->pv1() << "," << endl;
+    ss << "    \"Z\": " << *this->_reg->pv2() << "," << endl;
+    ss << "    \"t\": " << *this->_reg->pv3() << endl;    
     ss << "  }";
 
     return ss.str();
@@ -215,9 +204,9 @@ std::string SCL3300a::getJsonMin()
     stringstream ss;
 
     ss << endl << "  {" << endl;
-    ss << "    \"Min(X)\": " << *this->_reg->minPv0 << "," << endl;
-    ss << "    \"Min(Y)\": " << *this->_reg->minPv1 << "," << endl;
-    ss << "    \"Min(Z)\": " << *this->_reg->minPv2 << endl; 
+    ss << "    \"Min(X)\": " << *this->_reg->minPv0() << "," << endl;
+    ss << "    \"Min(Y)\": " << *this->_reg->minPv1() << "," << endl;
+    ss << "    \"Min(Z)\": " << *this->_reg->minPv2() << endl; 
     ss << "  }";
 
     return ss.str();
@@ -230,9 +219,9 @@ std::string SCL3300a::getJsonMax()
     stringstream ss;
 
     ss << endl << "  {" << endl;
-    ss << "    \"Max(X)\": " << *this->_reg->maxPv0 << "," << endl;
-    ss << "    \"Max(Y)\": " << *this->_reg->maxPv1 << "," << endl;
-    ss << "    \"Max(Z)\": " << *this->_reg->maxPv2 << endl;
+    ss << "    \"Max(X)\": " << *this->_reg->maxPv0() << "," << endl;
+    ss << "    \"Max(Y)\": " << *this->_reg->maxPv1() << "," << endl;
+    ss << "    \"Max(Z)\": " << *this->_reg->maxPv2() << endl;
     ss << "  }";
 
     return ss.str();
@@ -245,9 +234,9 @@ std::string SCL3300a::getJsonMean()
     stringstream ss;
 
     ss << endl << "  {" << endl;
-    ss << "    \"Mean(X)\": " << *this->_reg->meanPv0 << "," << endl;
-    ss << "    \"Mean(Y)\": " << *this->_reg->meanPv1 << "," << endl;
-    ss << "    \"Mean(Z)\": " << *this->_reg->meanPv2 << endl;
+    ss << "    \"Mean(X)\": " << *this->_reg->meanPv0() << "," << endl;
+    ss << "    \"Mean(Y)\": " << *this->_reg->meanPv1() << "," << endl;
+    ss << "    \"Mean(Z)\": " << *this->_reg->meanPv2() << endl;
     ss << "  }";
 
     return ss.str();
@@ -260,9 +249,9 @@ std::string SCL3300a::getJsonStdDev()
     stringstream ss;
 
     ss << endl << "  {" << endl;
-    ss << "    \"StdDev(X)\": " << *this->_reg->stdDevPv0 << "," << endl;
-    ss << "    \"StdDev(Y)\": " << *this->_reg->stdDevPv1 << "," << endl;
-    ss << "    \"StdDev(Z)\": " << *this->_reg->stdDevPv2 << endl;
+    ss << "    \"StdDev(X)\": " << *this->_reg->stdDevPv0() << "," << endl;
+    ss << "    \"StdDev(Y)\": " << *this->_reg->stdDevPv1() << "," << endl;
+    ss << "    \"StdDev(Z)\": " << *this->_reg->stdDevPv2() << endl;
     ss << "  }";
 
     return ss.str();
@@ -46,6 +46,9 @@ public:
     void init();
     void update();
 
+    /// @brief Publish statistics and amplitudes derived from them
+    void publishStatistics() override;
+
 
     std::string getJson();
     std::string getJsonAmplitude();
@@ -59,7 +59,7 @@ void SCL3400::init()
     // assert(status->RS == NORMAL);
 
     // change sample rate to 10Hz
-    *_reg->desiredCycleTimeUs = 100000;    
+    *_reg->desiredCycleTimeUs() = 100000;    
 }
 
 
@@ -76,31 +76,15 @@ void SCL3400::update()
     longToPacket(ExchangeBlock(CMD::Read_Status_Summary), packetT);
 
     // convert data to angles
-    *_reg->pv0 = static_cast<float>(getDegFromPacket(packetX));
-    *_reg->pv1 = static_cast<float>(getDegFromPacket(packetY));
+    *_reg->pv0() = static_cast<float>(getDegFromPacket(packetX));
+    *_reg->pv1() = static_cast<float>(getDegFromPacket(packetY));
 
     // extract temperature from packet and convert to degrees
     uint16_t raw_temp = (uint16_t)(packetT->DATA_H << 8) + packetT->DATA_L;
-    *_reg->pv3 = -273 + (static_cast<float>(raw_temp) / 18.9);
-
-    // if calcStat is true, update statistics
-    if(_reg->config->bits.calcStat)
-    {
-        // insert new values into ring buffer
-        rbpv0.insertOne(*_reg->pv0);
-        rbpv1.insertOne(*_reg->pv1);
-        rbpv3.insertOne(*_reg->pv3);
-
-        // update statistics
-        rbpv0.updateStatistics();
-        rbpv1.updateStatistics();
-        rbpv3.updateStatistics();
-
-        // update min, max stddev etc...
-        rbpv0.getStatistics(_reg->minPv0, _reg->maxPv0, _reg->meanPv0, _reg->stdDevPv0);
-        rbpv1.getStatistics(_reg->minPv1, _reg->maxPv1, _reg->meanPv1, _reg->stdDevPv1);
-        rbpv3.getStatistics(_reg->minPv3, _reg->maxPv3, _reg->meanPv3, _reg->stdDevPv3);
-    }
+    *_reg->pv3() = -273 + (static_cast<float>(raw_temp) / 18.9);
+
+    // filter and update statistics of pv0, pv1 and pv3, pv2 is not used
+    processSamples(0b1011);
 }
 
 
@@ -132,13 +116,13 @@ std::string SCL3400::getJson()
 
     // return values as JSON
     ss << "{" << endl;
-    ss << "\t\"X\":" << *_reg->pv0 << "," << endl;
-    ss << "\t\"Y\":" << *_reg->pv1 << "," << endl;
-    ss << "\t\"Avg(X)\":" << *_reg->meanPv0 << "," << endl;
-    ss << "\t\"Avg(Y)\":" << *_reg->meanPv1 << "," << endl;
-    ss << "\t\"StdDev(X)\":" << *_reg->stdDevPv0 << "," << endl;
-    ss << "\t\"StdDev(Y)\":" << *_reg->stdDevPv1 << "," << endl;
-    ss << "\t\"Avg(t)\":" << *_reg->meanPv3 << "," << endl;
+    ss << "\t\"X\":" << *_reg->pv0() << "," << endl;
+    ss << "\t\"Y\":" << *_reg->pv1() << "," << endl;
+    ss << "\t\"Avg(X)\":" << *_reg->meanPv0() << "," << endl;
+    ss << "\t\"Avg(Y)\":" << *_reg->meanPv1() << "," << endl;
+    ss << "\t\"StdDev(X)\":" << *_reg->stdDevPv0() << "," << endl;
+    ss << "\t\"StdDev(Y)\":" << *_reg->stdDevPv1() << "," << endl;
+    ss << "\t\"Avg(t)\":" << *_reg->meanPv3() << "," << endl;
 
     ss << "}";
 
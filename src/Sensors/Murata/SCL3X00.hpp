@@ -76,7 +76,7 @@ typedef enum
 
 
 
-class SCL3X00 : public Sensor
+class SCL3X00 : public Sensor<>
 {
 protected:
     typedef Sensor super;
@@ -42,5 +42,18 @@ devid_t Peripheral::getDevid()
     return _devid;
 }
 
+
+void Peripheral::publishStatistics()
+{
+    // peripheral without statistics, nothing to publish
+}
+
+
+void Peripheral::sample([[maybe_unused]] const uint64_t captureTimeUs)
+{
+    // peripheral without statistics does not need the time
+    update();
+}
+
 }   // namespace Xerxes
 
@@ -50,6 +50,20 @@ public:
      */
     devid_t getDevid();
 
+    /**
+     * @brief Write statistics of the process values to the register
+     * 
+     * Called on demand when statistics are calculated lazily, see MASK_CONFIG_LAZY_STATS
+     */
+    virtual void publishStatistics();
+
+    /**
+     * @brief Take a sample captured at the given time
+     * 
+     * @param captureTimeUs capture time of the sample, same as passed to Register::stampSample()
+     */
+    virtual void sample(const uint64_t captureTimeUs);
+
     virtual std::string getJson() = 0;
 };
 
@@ -3,21 +3,54 @@
 
 #include "Core/Register.hpp"
 #include "Sensors/Peripheral.hpp"
-#include "Buffer/StatisticBuffer.hpp"
+#include "Buffer/RingBuffer.hpp"
+#include "Buffer/StatisticBank.hpp"
+#include "Buffer/TieredStatistics.hpp"
+#include "Buffer/P2Quantile.hpp"
+#include "Filter/ChannelFilter.hpp"
 #include "Core/Definitions.h"
 #include "hardware/gpio.h"
 #include "hardware/spi.h"
 #include "hardware/adc.h"
+#include "hardware/sync.h"
 
 
 namespace Xerxes
 {
 
 
+/// @brief default length of statistics window, RING_BUFFER_LEN rounded up to power of two
+constexpr uint32_t defaultStatBufferLen = ringBufferLen(RING_BUFFER_LEN);
+
+/// @brief number of process values of the sensor, pv0..pv3
+constexpr uint8_t numProcessValues = PV_CHANNELS;
+
+static_assert(FILTER_BIQUAD_PV1_OFFSET - FILTER_BIQUAD_PV0_OFFSET == BIQUAD_COEFFS * sizeof(int32_t),
+    "biquad registers must hold BIQUAD_COEFFS coefficients per process value");
+
+/// @brief channel mask with all process values pv0..pv3
+constexpr uint8_t allProcessValues = (1 << numProcessValues) - 1;
+
+/// @brief default quantiles, used while the quantile register is out of range (0, 1)
+constexpr std::array<float, 3> statQuantiles = {QUANTILE_P0, QUANTILE_P1, QUANTILE_P2};
+
+/// @brief long term statistics windows: 10 s of 1 s blocks, 60 s of 6 s blocks
+constexpr uint8_t longTermTiers = 2;
+/// @brief number of blocks in each long term window
+constexpr uint8_t longTermBlocks = 10;
+/// @brief block of the 60 s window in blocks of the 10 s window
+constexpr uint32_t longTermRollUp = 6;
+
+
 /**
  * @brief Sensor class
  * 
+ * @tparam N - length of the statistics window in samples (power of two), 
+ * chosen by the sensor at compile time
+ * @tparam T - type of samples fed to the statistics, integer sensors use raw
+ * counts so the statistics are computed without soft-float
  */
+template <uint32_t N = defaultStatBufferLen, class T = float>
 class Sensor : public Peripheral
 {
 protected:
@@ -26,15 +59,60 @@ protected:
 
     Register* _reg;
 
-    // define ringbuffer (circular buffer) for each process value
-    /// @brief Ringbuffer for process value 0
-    StatisticBuffer<float> rbpv0;
-    /// @brief Ringbuffer for process value 1
-    StatisticBuffer<float> rbpv1;
-    /// @brief Ringbuffer for process value 2
-    StatisticBuffer<float> rbpv2;
-    /// @brief Ringbuffer for process value 3
-    StatisticBuffer<float> rbpv3;
+    /// @brief filter stage of process values pv0..pv3, configured by FILTER_* registers
+    std::array<ChannelFilter<T>, numProcessValues> filters;
+
+    /// @brief statistics of process values pv0..pv3, integer samples use fixed point statistics
+    StatisticBank<numProcessValues, N, T> stats;
+
+    /// @brief statistics of process values over 10 s and 60 s windows, sized in blocks not samples
+    TieredStatistics<numProcessValues, T, longTermTiers, longTermBlocks> longTermStats {{0, longTermRollUp}};
+    /// @brief capture time of the sample being processed in us, see sample()
+    uint64_t sampleTimeUs {0};
+    /// @brief end of the open 1 s block of long term statistics in us, 0 = no block yet
+    uint64_t blockEndUs {0};
+
+    /// @brief quantiles of process values over windows of QUANTILE_WINDOW_LEN samples, constant memory
+    StreamingQuantiles<numProcessValues, statQuantiles.size()> quantiles {statQuantiles, QUANTILE_WINDOW_LEN};
+
+    /// @brief guards stats, samples are inserted by the measuring core while the other one may publish
+    spin_lock_t* statLock = spin_lock_instance(spin_lock_claim_unused(true));
+    /// @brief process values used by the sensor, as given to the last processSamples()
+    uint8_t statMask {0};
+    /// @brief conversion factor from samples to process value unit
+    float statScale {1.0f};
+
+    /**
+     * @brief Filter new samples, write them to the process values and update statistics
+     * 
+     * Called by the sensor right after conversion. Statistics are updated only
+     * if calcStat is set and published to the register right away, unless
+     * lazyStat is set.
+     * 
+     * @param samples one sample per process value, pv0..pv3
+     * @param mask process values to update, bit n = pv n
+     * @param scale conversion factor from samples to process value unit
+     */
+    void processSamples(const T* samples, const uint8_t mask, const float scale = 1.0f);
+
+    /**
+     * @brief Filter the process values written by the sensor and update statistics
+     * 
+     * @param mask process values to update, bit n = pv n
+     */
+    void processSamples(const uint8_t mask);
+
+    /// @brief Insert filtered samples to the statistics
+    void updateStatistics(const T* samples, const uint8_t mask, const float scale);
+
+    /**
+     * @brief Insert samples to the quantile estimators, which work in float
+     * 
+     * @param samples one sample per process value, pv0..pv3
+     * @param mask process values to update, bit n = pv n
+     * @return true if the quantile window is complete and has to be latched
+     */
+    bool insertQuantiles(const T* samples, const uint8_t mask);
 
 public:
     using Peripheral::Peripheral;    
@@ -56,10 +134,188 @@ public:
     {};
 
     void update();
+
+    /**
+     * @brief Take a sample captured at the given time
+     * 
+     * Same as update(), the capture time delimits the blocks of the long term
+     * statistics, so their windows hold whatever the sampling rate is.
+     * 
+     * @param captureTimeUs capture time of the sample, same as passed to Register::stampSample()
+     */
+    void sample(const uint64_t captureTimeUs) override;
+
+    /**
+     * @brief Publish statistics of the current window to the register
+     * 
+     * Safe to call from the other core, the window is locked while the statistics are read out.
+     */
+    void publishStatistics() override;
     
 };
 
 
+template <uint32_t N, class T>
+Sensor<N, T>::Sensor(Register* reg) : _reg(reg)
+{
+    // statistics are statically sized, nothing to allocate
+}
+
+
+template <uint32_t N, class T>
+void Sensor<N, T>::processSamples(const T* samples, const uint8_t mask, const float scale)
+{
+    T filtered[numProcessValues] {};
+
+    for(uint8_t i=0; i<numProcessValues; i++)
+    {
+        if(!(mask & (1 << i)))
+        {
+            continue;
+        }
+
+        // filter registers are laid out per process value, biquad has BIQUAD_COEFFS coefficients each
+        filtered[i] = filters[i].apply(
+            samples[i],
+            _reg->filterTypePv()[i],
+            _reg->filterAlphaPv()[i],
+            _reg->filterBiquadPv() + i * BIQUAD_COEFFS
+        );
+        _reg->pv()[i] = filtered[i] * scale;
+    }
+
+    updateStatistics(filtered, mask, scale);
+}
+
+
+template <uint32_t N, class T>
+void Sensor<N, T>::processSamples(const uint8_t mask)
+{
+    const T samples[numProcessValues] = {
+        static_cast<T>(*_reg->pv0()),
+        static_cast<T>(*_reg->pv1()),
+        static_cast<T>(*_reg->pv2()),
+        static_cast<T>(*_reg->pv3())
+    };
+
+    processSamples(samples, mask);
+}
+
+
+template <uint32_t N, class T>
+void Sensor<N, T>::updateStatistics(const T* samples, const uint8_t mask, const float scale)
+{
+    // if calcStat is false, statistics are not used
+    if(!_reg->config()->bits.calcStat)
+    {
+        return;
+    }
+
+    // long term windows cover whole windows at most, a longer pause leaves them empty anyway
+    constexpr uint32_t maxEmptyBlocks = longTermBlocks * longTermRollUp;
+
+    // quantile estimators are used by this core only, keep their float math out of the lock
+    const bool quantileWindow = _reg->config()->bits.quantiles && insertQuantiles(samples, mask);
+
+    const uint32_t irq = spin_lock_blocking(statLock);
+    stats.insert(samples, mask);
+
+    // 1 s blocks by capture time, in sync mode samples do not come at desired cycle time
+    if(!blockEndUs)
+    {
+        blockEndUs = sampleTimeUs + _usInS;
+    }
+    for(uint32_t i=0; i<maxEmptyBlocks && sampleTimeUs >= blockEndUs; i++)
+    {
+        longTermStats.closeBlock();
+        blockEndUs += _usInS;
+    }
+    if(sampleTimeUs >= blockEndUs)
+    {
+        blockEndUs = sampleTimeUs + _usInS;
+    }
+    longTermStats.insert(samples);
+    if(quantileWindow)
+    {
+        quantiles.latch();
+    }
+    statMask = mask;
+    statScale = scale;
+    spin_unlock(statLock, irq);
+
+    // lazy statistics are published when they are read
+    if(!_reg->config()->bits.lazyStat)
+    {
+        publishStatistics();
+    }
+}
+
+
+template <uint32_t N, class T>
+bool Sensor<N, T>::insertQuantiles(const T* samples, const uint8_t mask)
+{
+    // register is written between samples on this core, a change restarts the window
+    std::array<float, statQuantiles.size()> p;
+    for(uint8_t q=0; q<p.size(); q++)
+    {
+        const float requested = _reg->quantileP()[q];
+        p[q] = requested > 0 && requested < 1 ? requested : statQuantiles[q];
+    }
+    quantiles.setQuantiles(p.data());
+
+    if constexpr (std::is_same_v<T, float>)
+    {
+        return quantiles.insert(samples, mask);
+    }
+    else
+    {
+        float values[numProcessValues];
+        for(uint8_t i=0; i<numProcessValues; i++)
+        {
+            values[i] = static_cast<float>(samples[i]);
+        }
+        return quantiles.insert(values, mask);
+    }
+}
+
+
+template <uint32_t N, class T>
+void Sensor<N, T>::publishStatistics()
+{
+    if(!_reg->config()->bits.calcStat)
+    {
+        return;
+    }
+
+    // register holds mean, stddev, min and max of pv0..pv3 as consecutive float arrays
+    const uint32_t irq = spin_lock_blocking(statLock);
+    stats.publish(_reg->meanPv0(), _reg->stdDevPv0(), _reg->minPv0(), _reg->maxPv0(), statMask, statScale);
+    longTermStats.publish(0, _reg->mean10sPv0(), _reg->stdDev10sPv0(), nullptr, nullptr, statMask, statScale);
+    longTermStats.publish(1, _reg->mean60sPv0(), _reg->stdDev60sPv0(), nullptr, nullptr, statMask, statScale);
+    // quantile registers are laid out quantile by quantile, pv0..pv3 each
+    if(_reg->config()->bits.quantiles)
+    {
+        quantiles.publish(_reg->quantile0Pv(), statMask, statScale);
+    }
+    spin_unlock(statLock, irq);
+}
+
+
+template <uint32_t N, class T>
+void Sensor<N, T>::update()
+{
+    processSamples(allProcessValues);
+}
+
+
+template <uint32_t N, class T>
+void Sensor<N, T>::sample(const uint64_t captureTimeUs)
+{
+    sampleTimeUs = captureTimeUs;
+    this->update();
+}
+
+
 }   // namespace Xerxes
 
 #endif // !__SENSOR_HPP
@@ -3,44 +3,65 @@
 #include "pico/stdlib.h"
 #include "pico/multicore.h"
 #include "hardware/watchdog.h"
-#include "pico/util/queue.h"
+#include "pico/mutex.h"
 
 #include "Core/Errors.h"
 #include "Core/BindWrapper.hpp"
 #include "Core/Slave.hpp"
 #include "Core/Register.hpp"
 #include "Communication/Callbacks.hpp"
+#include "Communication/MessageIds.h"
 #include "Hardware/Board/xerxes_rp2040.h"
 #include "Hardware/ClockUtils.hpp"
 #include "Hardware/InitUtils.hpp"
 #include "Hardware/Sleep.hpp"
+#include "Hardware/UserFlash.hpp"
 #include "Sensors/all.hpp"
 #include "Communication/RS485.hpp"
+#include "Communication/DmaTx.hpp"
+#include "Communication/SlotTimer.hpp"
 
 
 using namespace std;
 using namespace Xerxes;
 
 
-// forward declaration
-__SENSOR_CLASS sensor;
-
-
 Register _reg;  // main register
 
-/// @brief transmit FIFO queue for UART
-queue_t txFifo;
-/// @brief receive FIFO queue for UART
-queue_t rxFifo;
-
-RS485 xn(&txFifo, &rxFifo);     // RS485 interface
+// sensor is constructed in place, its statistic buffers are too big for the stack
+__SENSOR_CLASS sensor(&_reg);
+
+/// @brief transmit ring for UART, filled by RS485, drained into DMA by the main loop
+TxRing txFifo;
+/// @brief receive ring for UART, filled by DMA
+DmaRxRing rxRing;
+/// @brief transmitter for UART, sends frames by DMA
+DmaTx txDma;
+/// @brief held while the register is changed between samples and published, never while sampling
+mutex_t regMutex;
+/// @brief register writes waiting for core1, applied between samples
+WriteRing writeFifo;
+/// @brief addresses of masters whose writes core1 applied and published, acknowledged by the main loop
+SpscRing<uint8_t, PENDING_WRITES_DEPTH> ackFifo;
+/// @brief capture times of syncs waiting for core1 to sample
+SpscRing<uint64_t, PENDING_SYNCS_DEPTH> syncFifo;
+/// @brief time slot of this node in stream mode, started by broadcast sync
+SlotTimer streamSlot;
+/// @brief address of the master which sent the last sync, receives the stream
+uint8_t streamMaster = 0;
+
+RS485 xn(&txFifo, &rxRing, _reg.devAddress());     // RS485 interface
 Protocol xp(&xn);               // Xerxes protocol implementation
-Slave xs(&xp, *_reg.devAddress);   ///< Xerxes slave implementation
+Slave xs(&xp, *_reg.devAddress());   ///< Xerxes slave implementation
 
 volatile bool usrSwitchOn;                // user switch state
 volatile bool core1idle = true;  // core1 idle flag
 volatile bool useUsb = false;    // use usb uart flag
 volatile bool awake = true;
+volatile bool nvChanged = false;        // core1 applied a change of non-volatile registers
+volatile bool uartOverload = false;     // received bytes were lost or tx ring was full, core1 sets the error bit
+volatile bool commitRequested = false;  // master asked to commit non-volatile registers now
+volatile uint32_t baudSwitchTo = 0;    // baud rate the master asked to switch to, 0 = no switch requested
 
 /**
  * @brief Core 1 entry point, runs in background
@@ -48,6 +69,21 @@ volatile bool awake = true;
 void core1Entry();  
 
 
+/**
+ * @brief Apply queued writes of the master and publish them, called by core1 between samples
+ */
+static void applyWrites();
+
+
+/**
+ * @brief Store changed non-volatile registers to flash
+ * 
+ * @return true if flash is up to date
+ * @return false if core1 could not be parked, try again later
+ */
+bool commitNonVolatile();
+
+
 int main(void)
 {
     // enable watchdog for 200ms, pause on debug = true
@@ -79,7 +115,6 @@ int main(void)
     
 
     watchdog_update();
-    sensor = __SENSOR_CLASS(&_reg);
 
     #ifdef SHIELD_AI
     sensor.init(2, 3);
@@ -97,18 +132,19 @@ int main(void)
         // wait for usb to be ready
         sleep_hp(2'000'000);
         // print out error register
-        cout << "error register: " << bitset<32>(*_reg.error) << endl;
+        cout << "error register: " << bitset<32>(*_reg.error()) << endl;
         // cout sampling speed in Hz
-        cout << "sampling speed: " << (1000000.0f / (float)(*_reg.desiredCycleTimeUs)) << "Hz" << endl;
+        cout << "sampling speed: " << (1000000.0f / (float)(*_reg.desiredCycleTimeUs())) << "Hz" << endl;
         
         // set to free running mode and calculate statistics for usb uart mode so we can see the values
-        _reg.config->bits.freeRun = 1;
-        _reg.config->bits.calcStat = 1;
+        _reg.config()->bits.freeRun = 1;
+        _reg.config()->bits.calcStat = 1;
     }
     else
     {
         // init uart over RS485
         userInitUart();
+        xn.baudrateChanged(userBaudrate());
     }
 
 
@@ -116,24 +152,68 @@ int main(void)
     xs.bind(MSGID_PING,         unicast(    pingCallback));
     xs.bind(MSGID_WRITE,        unicast(    writeRegCallback));
     xs.bind(MSGID_READ,         unicast(    readRegCallback));
+    xs.bind(MSGID_READ_MULTI,   unicast(    readMultiCallback));
+    xs.bind(MSGID_POLL_CHANGES, unicast(    pollChangesCallback));
+    xs.bind(MSGID_COMMIT,       unicast(    commitCallback));
+    xs.bind(MSGID_BAUD_SWITCH,  broadcast(  baudSwitchCallback));
     xs.bind(MSGID_SYNC,         broadcast(  syncCallback));
     xs.bind(MSGID_SLEEP,        broadcast(  sleepCallback));
     xs.bind(MSGID_RESET_SOFT,   broadcast(  softResetCallback));
     xs.bind(MSGID_RESET_HARD,   unicast(    factoryResetCallback));
 
     // drain uart fifos, just in case there is something in there
-    while(!queue_is_empty(&txFifo)) queue_remove_blocking(&txFifo, NULL);
-    while(!queue_is_empty(&rxFifo)) queue_remove_blocking(&rxFifo, NULL);
+    txFifo.clear();
+    rxRing.clear();
 
-    // start core1
+    // publish initial register values and start core1
+    mutex_init(&regMutex);
+    _reg.publish();
     multicore_launch_core1(core1Entry);
 
+    uint64_t commitDueUs = 0;   // time to commit non-volatile registers, 0 = nothing to commit
+    bool busIdle = true;        // no message was received or sent in the last loop
+
+    // baud rate is not confirmed until a valid frame arrives at it, for any node, 0 = confirmed
+    uint64_t baudFallbackUs = 0;
+    // valid frames received before the baud rate was switched
+    uint32_t framesAtSwitch = 0;
+
+    // switch the link and wait for a valid frame to confirm the new rate
+    auto switchBaudrate = [&](const uint32_t baudrate)
+    {
+        userSetBaudrate(baudrate);
+        xn.baudrateChanged(baudrate);
+        xn.verifyOtherFrames(true);
+        framesAtSwitch = xn.validFrames();
+        baudFallbackUs = time_us_64() + userBaudFallbackUs();
+    };
+
+    if(!useUsb && userBaudrate() != DEFAULT_BAUDRATE)
+    {
+        switchBaudrate(userBaudrate());
+    }
+
     // main loop, runs forever, handles all communication in this loop
     while(1)
     {    
         // update watchdog
          watchdog_update();
 
+        // non-volatile registers changed, restart the delay so consecutive writes share one commit
+        if(nvChanged)
+        {
+            nvChanged = false;
+            commitDueUs = time_us_64() + NV_COMMIT_DELAY_US;
+        }
+
+        // erasing flash blocks interrupts for ~50ms, do it only while the bus is idle
+        bool commitDue = commitRequested || (commitDueUs && time_us_64() >= commitDueUs);
+        if(commitDue && busIdle)
+        {
+            commitRequested = false;
+            commitDueUs = commitNonVolatile() ? 0 : time_us_64() + NV_COMMIT_DELAY_US;
+        }
+
         if(useUsb)
         {
             constexpr uint32_t printFrequencyHz = 10;
@@ -143,10 +223,18 @@ int main(void)
             auto timestamp = time_us_64();
             cout << "{" << endl;
             cout << "\"timestamp\":" << timestamp << "," << endl;
-            cout << "\"samplingSpeedHz\":" << (1000000.0f / (float)(*_reg.desiredCycleTimeUs)) << "," << endl;
-            cout << "\"netCycleTimeUs\":" << *_reg.netCycleTimeUs << "," << endl;
-            cout << "\"errors\":" << (*_reg.error) << "," << endl;
+            cout << "\"samplingSpeedHz\":" << (1000000.0f / (float)(*_reg.desiredCycleTimeUs())) << "," << endl;
+            cout << "\"netCycleTimeUs\":" << *_reg.netCycleTimeUs() << "," << endl;
+            cout << "\"errors\":" << (*_reg.error()) << "," << endl;
                         
+            // statistics are calculated lazily, bring them up to date before printing
+            if(_reg.config()->bits.lazyStat)
+            {
+                mutex_enter_blocking(&regMutex);
+                sensor.publishStatistics();
+                mutex_exit(&regMutex);
+            }
+
             // cout sensor values in json format
             cout << "\"sensor\":" << sensor.getJson() << endl;
             cout << "}" << endl << endl;
@@ -160,31 +248,77 @@ int main(void)
         }
         else
         {
-            // running on RS485, sync for incoming messages from master, timeout = 5ms
-            xs.sync(5000);
-            
-            // send char if tx queue is not empty and uart is writable
-            if(!queue_is_empty(&txFifo))
-            {   
-                uint txLen = queue_get_level(&txFifo);
-                assert(txLen <= RX_TX_QUEUE_SIZE);
+            // running on RS485, handle a message from master if one was completed, never waits for bytes
+            busIdle = !xs.sync(5000);
 
-                uint8_t toSend[txLen];
+            // writes core1 applied and published meanwhile, acknowledge them in order
+            uint8_t master;
+            while(ackFifo.pop(master))
+            {
+                xs.send(master, MSGID_ACK_OK);
+                busIdle = false;
+            }
 
-                // drain queue
-                for(uint i = 0; i < txLen; i++)
+            if(baudFallbackUs && xn.validFrames() != framesAtSwitch)
+            {
+                // a valid frame arrived, also one for another node means the baud rate works
+                baudFallbackUs = 0;
+                xn.verifyOtherFrames(false);
+            }
+            else if(baudFallbackUs && time_us_64() >= baudFallbackUs)
+            {
+                // nobody talks at this baud rate, try the one every node starts with and back until a frame arrives
+                const uint32_t other = xn.baudrate() == DEFAULT_BAUDRATE ? userBaudrate() : DEFAULT_BAUDRATE;
+                if(other != xn.baudrate())
+                {
+                    switchBaudrate(other);
+                }
+                else
                 {
-                    queue_remove_blocking(&txFifo, &toSend[i]);
+                    baudFallbackUs = 0;
+                    xn.verifyOtherFrames(false);
                 }
+            }
+            
+            // stream mode, send the sample of the last cycle in own slot, it goes out with the queued bytes below
+            // the frame must end inside the slot and go out right away, otherwise the slot is skipped
+            if(_reg.config()->bits.stream)
+            {
+                // core1 samples on the sync, the sample before it must not be sent instead
+                uint64_t sampleUs = 0;
+                _reg.readPublished(reinterpret_cast<uint8_t*>(&sampleUs), CAPTURE_TIME_US_OFFSET, sizeof(sampleUs));
 
-                // write char to bus, this will clear the interrupt
-                uart_write_blocking(uart0, toSend, txLen);
+                const bool ready = sampleUs >= streamSlot.syncUs() && txFifo.empty() && txDma.idle();
+                if(streamSlot.due(time_us_64(), xn.frameTimeUs(STREAM_FRAME_LEN), ready))
+                {
+                    sendStreamValue();
+                    busIdle = false;
+                }
+            }
+
+            // hand queued bytes to DMA once the previous frame is out, do not wait for it
+            if(!txFifo.empty() && txDma.idle())
+            {   
+                // drain ring in one go
+                uint32_t txLen = txFifo.pop(std::span<uint8_t>(txDma.data(), DmaTx::SIZE));
+                txDma.send(txLen);
+            }
+
+            // staged baud rate takes effect once everything queued before the request is out
+            if(baudSwitchTo && txFifo.empty() && txDma.idle())
+            {
+                const uint32_t baudrate = baudSwitchTo;
+                baudSwitchTo = 0;
+                switchBaudrate(baudrate);
             }
+
+            // bytes of the next message may be arriving already or the reply is still going out
+            busIdle = busIdle && !xn.receiving() && !rxRing.available() && txDma.idle();
         
-            if(queue_is_full(&txFifo) || queue_is_full(&rxFifo))
+            if(txFifo.full() || rxRing.overrun())
             {
-                // rx fifo is full, set the cpu_overload error flag
-                _reg.errorSet(ERROR_MASK_UART_OVERLOAD);
+                // tx fifo is full or received bytes were lost, core1 sets the uart_overload error flag
+                uartOverload = true;
             }
 
             // save power in release mode
@@ -214,15 +348,24 @@ void core1Entry()
     // core1 mainloop
     while(true)
     {
-        // core is set to free run, start cycle
+        // writes received during the last sample take effect before the next one
+        applyWrites();
+
+        // sample on sync, in free run mode at every cycle too
+        uint64_t syncUs = 0;
+        const bool synced = syncFifo.pop(syncUs);
+        const bool sampled = synced || _reg.config()->bits.freeRun;
+
         auto startOfCycle = time_us_64();
+        const uint64_t captureTime = synced ? syncUs : startOfCycle;
 
         // turn on led for a short time to signal start of cycle
         gpio_put(USR_LED_PIN, 1);
 
-        if(_reg.config->bits.freeRun)
+        // register is not locked while sampling, core0 hands writes and syncs over through the rings
+        if(sampled)
         {
-            sensor.update(); 
+            sensor.sample(captureTime); 
         }
 
         // turn off led
@@ -232,26 +375,117 @@ void core1Entry()
         endOfCycle = time_us_64();
         cycleDuration = endOfCycle - startOfCycle;
 
+        // calculate remaining sleep time
+        sleepFor = *_reg.desiredCycleTimeUs() - cycleDuration;
+
+        // stamp and publish the sample, core0 waits only for this to acknowledge or publish lazy statistics
+        mutex_enter_blocking(&regMutex);
+
+        if(sampled)
+        {
+            _reg.stampSample(captureTime);
+        }
+
         // calculate net cycle time as moving average
-        *_reg.netCycleTimeUs = static_cast<uint32_t>(0.9 * *_reg.netCycleTimeUs) + static_cast<uint32_t>(0.1 * static_cast<uint32_t>(cycleDuration));
+        *_reg.netCycleTimeUs() = static_cast<uint32_t>(0.9 * *_reg.netCycleTimeUs()) + static_cast<uint32_t>(0.1 * static_cast<uint32_t>(cycleDuration));
 
-        // calculate remaining sleep time
-        sleepFor = *_reg.desiredCycleTimeUs - cycleDuration;
-        
-        // sleep for the remaining time
         if(sleepFor > 0)
         {
-            core1idle = true;
-            sleep_us(sleepFor);
-            core1idle = false;
             _reg.errorClear(ERROR_MASK_SENSOR_OVERLOAD);
         }
         else
         {
             _reg.errorSet(ERROR_MASK_SENSOR_OVERLOAD);
         }
+
+        if(uartOverload)
+        {
+            uartOverload = false;
+            _reg.errorSet(ERROR_MASK_UART_OVERLOAD);
+        }
+
+        // make values of this cycle visible to core0
+        _reg.publish();
+        mutex_exit(&regMutex);
+        
+        // sleep for the remaining time, core0 wakes core1 up to apply a write or to sample on sync
+        if(sleepFor > 0)
+        {
+            const absolute_time_t wakeUp = from_us_since_boot(endOfCycle + sleepFor);
+
+            core1idle = true;
+            while(syncFifo.empty() && !best_effort_wfe_or_timeout(wakeUp))
+            {
+                applyWrites();
+            }
+            core1idle = false;
+        }
         
     }
     
     core1idle = true;
 }
+
+
+static void applyWrites()
+{
+    if(writeFifo.empty())
+    {
+        return;
+    }
+
+    // large for the stack of core1, used by core1 only
+    static RegisterWrite write;
+    uint8_t masters[PENDING_WRITES_DEPTH];
+    uint32_t count = 0;
+    bool nvWritten = false;
+
+    // take only writes whose ACK fits, the main loop sends them
+    const uint32_t space = ackFifo.free();
+
+    mutex_enter_blocking(&regMutex);
+    while(count < space && writeFifo.pop(write))
+    {
+        nvWritten |= _reg.apply(write);
+        masters[count++] = write.master;
+    }
+    _reg.publish();
+    mutex_exit(&regMutex);
+
+    if(nvWritten)
+    {
+        // main loop stores the non-volatile range to flash after the commit delay
+        nvChanged = true;
+    }
+
+    // published, a read after the ACK sees the new values
+    ackFifo.push(std::span<const uint8_t>(masters, count));
+}
+
+
+bool commitNonVolatile()
+{
+    // own the register so core1 does not apply a write meanwhile
+    mutex_enter_blocking(&regMutex);
+
+    if(_reg.nvDirty())
+    {
+        // core1 executes from flash too, park it while the sector is erased and programmed
+        if(!multicore_lockout_start_timeout_us(10'000))
+        {
+            mutex_exit(&regMutex);
+            return false;
+        }
+
+        // update flash, takes ~50ms to complete hence the 2 watchdog updates
+        watchdog_update();
+        updateFlash(_reg.memTable);
+        watchdog_update();
+
+        multicore_lockout_end_timeout_us(10'000);
+        _reg.nvClean();
+    }
+
+    mutex_exit(&regMutex);
+    return true;
+}
@@ -0,0 +1,88 @@
+/**
+ * @brief Host benchmark of the per-sample cost of the quantile estimators
+ * 
+ * Compares streaming P2 estimation of 3 quantiles on 4 channels with
+ * selecting the same quantiles from a copy of the ring buffer every cycle.
+ */
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "P2Quantile.hpp"
+
+
+constexpr uint8_t channels = 4;
+constexpr uint32_t windowLen = 128;
+constexpr uint32_t numSamples = 1'000'000;
+constexpr std::array<float, 3> quantiles = {0.5f, 0.95f, 0.99f};
+
+
+/// @brief keep the optimizer from removing the benchmarked work
+volatile float sink;
+
+
+template <class F>
+double nsPerSample(F &&f)
+{
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    const auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(end - start).count() / numSamples;
+}
+
+
+int main()
+{
+    std::mt19937 gen(1);
+    std::normal_distribution<float> noise(0, 1);
+
+    std::vector<float> samples(numSamples * channels);
+    for(auto &s : samples) s = noise(gen);
+
+    const double streaming = nsPerSample([&]
+    {
+        Xerxes::StreamingQuantiles<channels, quantiles.size()> estimator(quantiles, windowLen);
+        std::array<float, quantiles.size() * channels> out {};
+
+        for(uint32_t i=0; i<numSamples; i++)
+        {
+            if(estimator.insert(&samples[i * channels], 0b1111))
+            {
+                estimator.latch();
+            }
+            estimator.publish(out.data(), 0b1111);
+            sink = out[0];
+        }
+    });
+
+    const double selecting = nsPerSample([&]
+    {
+        std::array<std::array<float, windowLen>, channels> window {};
+        std::array<float, windowLen> scratch;
+
+        for(uint32_t i=0; i<numSamples; i++)
+        {
+            for(uint8_t ch=0; ch<channels; ch++)
+            {
+                window[ch][i % windowLen] = samples[i * channels + ch];
+                scratch = window[ch];
+
+                for(const float p : quantiles)
+                {
+                    auto nth = scratch.begin() + static_cast<uint32_t>(p * (windowLen - 1));
+                    std::nth_element(scratch.begin(), nth, scratch.end());
+                    sink = *nth;
+                }
+            }
+        }
+    });
+
+    std::cout << "P2 streaming:        " << streaming << " ns/sample" << std::endl;
+    std::cout << "nth_element window:  " << selecting << " ns/sample" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,142 @@
+/**
+ * @brief Host benchmark of moving bytes from one thread to another
+ * 
+ * Compares a mutex guarded queue, which stands in for queue_t and its
+ * spinlock taken for every byte, with the lock-free ring used byte by byte
+ * and in bulk. Bytes are produced in frames of typical reply length.
+ */
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <span>
+#include <thread>
+
+#include "SpscRing.hpp"
+
+
+constexpr uint32_t ringSize = 256;
+constexpr uint32_t frameLen = 64;
+constexpr uint32_t numBytes = 10'000'000;
+
+
+/// @brief queue with a lock around every access, like queue_t
+class LockedQueue
+{
+private:
+    std::mutex lock;
+    std::array<uint8_t, ringSize> data {};
+    uint32_t head {0};
+    uint32_t tail {0};
+
+public:
+    bool push(const uint8_t byte)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if(head - tail == ringSize) return false;
+        data[head++ % ringSize] = byte;
+        return true;
+    }
+
+    bool pop(uint8_t &byte)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if(head == tail) return false;
+        byte = data[tail++ % ringSize];
+        return true;
+    }
+};
+
+
+/// @brief keep the optimizer from removing the benchmarked work
+volatile uint8_t sink;
+
+
+/**
+ * @brief Run producer and consumer on two threads and time the transfer
+ * 
+ * @param produce called as produce(frame) until it returned numBytes in total
+ * @param consume called until it returned numBytes in total
+ * @return double ns per transferred byte
+ */
+template <class P, class C>
+double nsPerByte(P &&produce, C &&consume)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    std::thread producer([&]
+    {
+        std::array<uint8_t, frameLen> frame;
+        for(uint32_t i=0; i<frameLen; i++) frame[i] = static_cast<uint8_t>(i);
+
+        for(uint32_t sent=0; sent<numBytes; sent += frameLen)
+        {
+            produce(frame);
+        }
+    });
+
+    for(uint32_t received=0; received<numBytes;)
+    {
+        const uint32_t len = consume();
+        // nothing to read, let the producer run if both share a core
+        if(!len) std::this_thread::yield();
+        received += len;
+    }
+
+    producer.join();
+    const auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(end - start).count() / numBytes;
+}
+
+
+int main()
+{
+    LockedQueue locked;
+    const double lockedBytes = nsPerByte([&](const auto &frame)
+    {
+        for(const auto byte : frame) while(!locked.push(byte)) std::this_thread::yield();
+    }, [&]
+    {
+        uint8_t byte;
+        if(!locked.pop(byte)) return 0u;
+        sink = byte;
+        return 1u;
+    });
+
+    Xerxes::SpscRing<uint8_t, ringSize> ring;
+    const double ringBytes = nsPerByte([&](const auto &frame)
+    {
+        for(const auto byte : frame) while(!ring.push(byte)) std::this_thread::yield();
+    }, [&]
+    {
+        uint8_t byte;
+        if(!ring.pop(byte)) return 0u;
+        sink = byte;
+        return 1u;
+    });
+
+    Xerxes::SpscRing<uint8_t, ringSize> bulkRing;
+    const double ringBulk = nsPerByte([&](const auto &frame)
+    {
+        std::span<const uint8_t> rest(frame);
+        while(!rest.empty())
+        {
+            const uint32_t pushed = bulkRing.push(rest);
+            if(!pushed) std::this_thread::yield();
+            rest = rest.subspan(pushed);
+        }
+    }, [&]
+    {
+        std::array<uint8_t, ringSize> out;
+        uint32_t len = bulkRing.pop(std::span<uint8_t>(out));
+        if(len) sink = out[len - 1];
+        return len;
+    });
+
+    std::cout << "locked queue, per byte:  " << lockedBytes << " ns/byte" << std::endl;
+    std::cout << "SPSC ring, per byte:     " << ringBytes << " ns/byte" << std::endl;
+    std::cout << "SPSC ring, bulk:         " << ringBulk << " ns/byte" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include "ChannelFilter.hpp"
+
+
+using namespace Xerxes;
+
+
+/// @brief EMA alpha in fixed point
+constexpr uint32_t alphaQ(const double alpha)
+{
+    return static_cast<uint32_t>(alpha * (1 << EMA_ALPHA_FRAC_BITS));
+}
+
+
+/// @brief biquad coefficient in fixed point
+constexpr int32_t coeffQ(const double c)
+{
+    return static_cast<int32_t>(std::lround(c * (1 << BIQUAD_FRAC_BITS)));
+}
+
+
+TEST(ChannelFilter, passThrough)
+{
+    ChannelFilter<float> filter;
+    for(int i=0; i<10; i++)
+    {
+        EXPECT_EQ(filter.apply(i, FILTER_NONE, 0, nullptr), i);
+    }
+}
+
+
+TEST(ChannelFilter, emaFloat)
+{
+    ChannelFilter<float> filter;
+
+    // primed with the first sample, no step from zero
+    EXPECT_FLOAT_EQ(filter.apply(10, FILTER_EMA, alphaQ(0.25), nullptr), 10);
+    EXPECT_FLOAT_EQ(filter.apply(20, FILTER_EMA, alphaQ(0.25), nullptr), 12.5);
+    EXPECT_FLOAT_EQ(filter.apply(20, FILTER_EMA, alphaQ(0.25), nullptr), 14.375);
+}
+
+
+TEST(ChannelFilter, emaIntMatchesFloat)
+{
+    ChannelFilter<int32_t> fixedPoint;
+    ChannelFilter<double> reference;
+
+    // small alpha must not stall on integer samples
+    constexpr uint32_t alpha = alphaQ(1.0 / 1024);
+    fixedPoint.apply(0, FILTER_EMA, alpha, nullptr);
+    reference.apply(0, FILTER_EMA, alpha, nullptr);
+
+    for(int i=0; i<5000; i++)
+    {
+        const int32_t y = fixedPoint.apply(1000, FILTER_EMA, alpha, nullptr);
+        const double expected = reference.apply(1000, FILTER_EMA, alpha, nullptr);
+        EXPECT_NEAR(y, expected, 1);
+    }
+}
+
+
+TEST(ChannelFilter, biquadLowPass)
+{
+    // 2nd order butterworth low pass, fc = fs / 10
+    const int32_t coeffs[BIQUAD_COEFFS] = {
+        coeffQ(0.0674552738890719), coeffQ(0.1349105477781438), coeffQ(0.0674552738890719),
+        coeffQ(-1.1429805025399011), coeffQ(0.4128015980961887)
+    };
+
+    ChannelFilter<float> floating;
+    ChannelFilter<int32_t> fixedPoint;
+
+    // unit gain at DC, settles to the step
+    floating.apply(0, FILTER_BIQUAD, 0, coeffs);
+    fixedPoint.apply(0, FILTER_BIQUAD, 0, coeffs);
+    float y = 0;
+    int32_t yi = 0;
+    for(int i=0; i<100; i++)
+    {
+        y = floating.apply(1000, FILTER_BIQUAD, 0, coeffs);
+        yi = fixedPoint.apply(1000, FILTER_BIQUAD, 0, coeffs);
+    }
+    EXPECT_NEAR(y, 1000, 0.01);
+    EXPECT_NEAR(yi, 1000, 1);
+
+    // nyquist is blocked
+    for(int i=0; i<100; i++)
+    {
+        y = floating.apply(i % 2 ? 1000 : -1000, FILTER_BIQUAD, 0, coeffs);
+    }
+    EXPECT_NEAR(y, 0, 1);
+}
@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+#include <span>
+#include <vector>
+#include "FrameParser.hpp"
+
+
+using namespace Xerxes;
+
+
+/// @brief build a frame around the body, checksum makes all bytes sum up to 0
+static std::vector<uint8_t> makeFrame(const std::vector<uint8_t> &body)
+{
+    std::vector<uint8_t> frame {FrameParser::SOH, static_cast<uint8_t>(body.size() + 3)};
+    frame.insert(frame.end(), body.begin(), body.end());
+
+    uint8_t sum = 0;
+    for(auto byte : frame) sum += byte;
+    frame.emplace_back(static_cast<uint8_t>(-sum));
+
+    return frame;
+}
+
+
+TEST(FrameParser, parsesWholeFrame)
+{
+    FrameParser parser;
+    std::vector<uint8_t> body {0x01, 0x02, 0x00, 0x01, 0xAA};
+    auto frame = makeFrame(body);
+
+    EXPECT_EQ(parser.parse(frame), frame.size());
+    ASSERT_TRUE(parser.complete());
+    EXPECT_EQ(std::vector<uint8_t>(parser.frame().begin(), parser.frame().end()), body);
+    EXPECT_EQ(parser.errors(), 0);
+}
+
+
+TEST(FrameParser, resumesSplitFrame)
+{
+    FrameParser parser;
+    std::vector<uint8_t> body {0x01, 0x02, 0x00, 0x01, 0x10, 0x20, 0x30};
+    auto frame = makeFrame(body);
+
+    // one byte per call, state is kept in between
+    for(size_t i = 0; i < frame.size() - 1; i++)
+    {
+        EXPECT_EQ(parser.parse(std::span<const uint8_t>(&frame[i], 1)), 1);
+        EXPECT_FALSE(parser.complete());
+        EXPECT_TRUE(parser.receiving());
+    }
+    parser.parse(std::span<const uint8_t>(&frame.back(), 1));
+
+    ASSERT_TRUE(parser.complete());
+    EXPECT_EQ(std::vector<uint8_t>(parser.frame().begin(), parser.frame().end()), body);
+}
+
+
+TEST(FrameParser, stopsAtEndOfFrame)
+{
+    FrameParser parser;
+    auto first = makeFrame({0x01, 0x02, 0x00, 0x01});
+    auto second = makeFrame({0x03, 0x04, 0x00, 0x02});
+
+    // garbage before the frame is skipped
+    std::vector<uint8_t> stream {0x55, 0xFF};
+    stream.insert(stream.end(), first.begin(), first.end());
+    stream.insert(stream.end(), second.begin(), second.end());
+
+    uint32_t used = parser.parse(stream);
+    EXPECT_EQ(used, 2 + first.size());
+    ASSERT_TRUE(parser.complete());
+    EXPECT_EQ(parser.frame()[0], 0x01);
+
+    EXPECT_EQ(parser.parse(std::span<const uint8_t>(stream).subspan(used)), second.size());
+    ASSERT_TRUE(parser.complete());
+    EXPECT_EQ(parser.frame()[0], 0x03);
+}
+
+
+TEST(FrameParser, dropsBadChecksumAndResyncs)
+{
+    FrameParser parser;
+    auto bad = makeFrame({0x01, 0x02, 0x00, 0x01});
+    bad.back()++;
+    auto good = makeFrame({0x01, 0x02, 0x00, 0x03});
+
+    parser.parse(bad);
+    EXPECT_FALSE(parser.complete());
+    EXPECT_EQ(parser.errors(), 1);
+
+    parser.parse(good);
+    ASSERT_TRUE(parser.complete());
+    EXPECT_EQ(parser.frame()[3], 0x03);
+}
+
+
+TEST(FrameParser, badLengthMayBeNextSoh)
+{
+    FrameParser parser;
+    auto good = makeFrame({0x01, 0x02, 0x00, 0x01});
+
+    // SOH followed by an impossible length, which is the SOH of the real frame
+    std::vector<uint8_t> stream {FrameParser::SOH};
+    stream.insert(stream.end(), good.begin(), good.end());
+
+    EXPECT_EQ(parser.parse(stream), stream.size());
+    EXPECT_TRUE(parser.complete());
+    EXPECT_EQ(parser.errors(), 1);
+}
+
+
+TEST(FrameParser, skipsFramesForOtherNodes)
+{
+    uint8_t address = 0x02;
+    FrameParser parser(&address);
+    // SOH inside a skipped body must not be taken for a frame start
+    auto other = makeFrame({0x00, 0x05, 0x00, 0x01, FrameParser::SOH, 0x22});
+    auto own = makeFrame({0x00, 0x02, 0x00, 0x01});
+    auto broadcast = makeFrame({0x00, FrameParser::BROADCAST, 0x00, 0x01});
+
+    // header is taken first, the rest of a foreign frame is skipped by length
+    EXPECT_EQ(parser.parse(std::span<const uint8_t>(other).first(4)), 4);
+    EXPECT_TRUE(parser.skipping());
+    EXPECT_EQ(parser.needed(), other.size() - 4);
+
+    EXPECT_EQ(parser.parse(std::span<const uint8_t>(other).subspan(4)), other.size() - 4);
+    EXPECT_FALSE(parser.receiving());
+    EXPECT_EQ(parser.errors(), 0);
+
+    parser.parse(own);
+    EXPECT_TRUE(parser.complete());
+    parser.parse(broadcast);
+    EXPECT_TRUE(parser.complete());
+
+    // address is read for every frame
+    address = 0x05;
+    parser.parse(own);
+    EXPECT_FALSE(parser.complete());
+    EXPECT_FALSE(parser.receiving());
+}
+
+
+TEST(FrameParser, verifiesParsedFramesForOtherNodes)
+{
+    uint8_t address = 0x02;
+    FrameParser parser(&address);
+    auto other = makeFrame({0x00, 0x05, 0x00, 0x01, 0x22});
+    auto own = makeFrame({0x00, 0x02, 0x00, 0x01});
+
+    // skipped bytes which are parsed are summed, a valid frame is counted
+    EXPECT_EQ(parser.parse(other), other.size());
+    EXPECT_EQ(parser.valid(), 1);
+
+    // bad checksum of a foreign frame is an error, not a valid frame
+    other.back()++;
+    parser.parse(other);
+    EXPECT_EQ(parser.valid(), 1);
+    EXPECT_EQ(parser.errors(), 1);
+
+    // bytes dropped by skip() are not seen, the frame is neither valid nor an error
+    other.back()--;
+    parser.parse(std::span<const uint8_t>(other).first(4));
+    parser.skip(parser.needed());
+    EXPECT_FALSE(parser.receiving());
+    EXPECT_EQ(parser.valid(), 1);
+    EXPECT_EQ(parser.errors(), 1);
+
+    parser.parse(own);
+    EXPECT_TRUE(parser.complete());
+    EXPECT_EQ(parser.valid(), 2);
+}
+
+
+TEST(FrameParser, resetResyncsAfterCorruptedLength)
+{
+    FrameParser parser;
+    auto good = makeFrame({0x01, 0x02, 0x00, 0x01});
+
+    // length byte was corrupted to a long frame, parser would take the next frame as body
+    std::vector<uint8_t> corrupted {FrameParser::SOH, 0xF0, 0x01, 0x02};
+    parser.parse(corrupted);
+    EXPECT_TRUE(parser.receiving());
+
+    // line went quiet, frame is dropped and the next one is found
+    parser.reset();
+    EXPECT_FALSE(parser.receiving());
+    parser.parse(good);
+    EXPECT_TRUE(parser.complete());
+}
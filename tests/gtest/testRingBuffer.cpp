@@ -1,6 +1,11 @@
 #include <gtest/gtest.h>
 #include <iostream>
+#include <vector>
 #include "StatisticBuffer.hpp"
+#include "IntStatisticBuffer.hpp"
+#include "StatisticBank.hpp"
+#include "TieredStatistics.hpp"
+#include "P2Quantile.hpp"
 
 
 TEST(StatisticBuffer, getStdDevDouble)
@@ -77,4 +82,610 @@ TEST(StatisticBuffer, initializerList)
     EXPECT_FLOAT_EQ(rb.getMin(), -INFINITY);
     EXPECT_FLOAT_EQ(rb.getMax(), 9);
     EXPECT_FLOAT_EQ(rb.getLast(), 8);
-}
\ No newline at end of file
+}
+
+TEST(StatisticBuffer, incrementalMatchesTwoPass)
+{
+    Xerxes::StatisticBuffer<float> incremental(100);
+    Xerxes::StatisticBuffer<float> twoPass(100);
+    std::mt19937 gen(42);
+    std::normal_distribution<float> noise(1013.25f, 0.5f);
+
+    // run over several window wraps, compare after every insert
+    for(int i=0; i<1000; i++)
+    {
+        float sample = noise(gen);
+        incremental.insertOne(sample);
+        twoPass.insertOne(sample);
+
+        incremental.updateStatistics();
+        twoPass.recalculateStatistics();
+
+        EXPECT_NEAR(incremental.getMean(), twoPass.getMean(), 1e-4);
+        EXPECT_NEAR(incremental.getStdDev(), twoPass.getStdDev(), 1e-4);
+        EXPECT_FLOAT_EQ(incremental.getMin(), twoPass.getMin());
+        EXPECT_FLOAT_EQ(incremental.getMax(), twoPass.getMax());
+    }
+}
+
+
+TEST(StatisticBuffer, incrementalMatchesTwoPassInt)
+{
+    Xerxes::StatisticBuffer<int> incremental(10);
+    Xerxes::StatisticBuffer<int> twoPass(10);
+
+    // start collecting running sums before the window is full
+    incremental.updateStatistics();
+    for(int i=0; i<95; i++)
+    {
+        int sample = (i * 7919) % 1000 - 500;
+        incremental.insertOne(sample);
+        twoPass.insertOne(sample);
+
+        incremental.updateStatistics();
+        twoPass.recalculateStatistics();
+
+        EXPECT_NEAR(incremental.getMean(), twoPass.getMean(), 1e-3);
+        EXPECT_NEAR(incremental.getStdDev(), twoPass.getStdDev(), 1e-3);
+    }
+}
+
+
+TEST(StatisticBuffer, slidingMinMax)
+{
+    Xerxes::StatisticBuffer<double> rb(4);
+    rb.updateStatistics();
+
+    // descending ramp, minimum is always the newest sample
+    for(int i=10; i>0; i--)
+    {
+        rb.insertOne(i);
+        rb.updateStatistics();
+        EXPECT_FLOAT_EQ(rb.getMin(), i);
+    }
+    EXPECT_FLOAT_EQ(rb.getMax(), 4);
+
+    // ascending ramp, old minimum must expire from the window
+    for(int i=1; i<=10; i++)
+    {
+        rb.insertOne(100 + i);
+        rb.updateStatistics();
+        EXPECT_FLOAT_EQ(rb.getMax(), 100 + i);
+    }
+    EXPECT_FLOAT_EQ(rb.getMin(), 107);
+}
+
+
+TEST(RingBuffer, fixedSizeGetLast)
+{
+    Xerxes::RingBuffer<double, 16> rb;
+    for(int i=1; i<55; i++)
+    {
+        rb.insertOne(i);
+        EXPECT_FLOAT_EQ(rb.getLast(), i);
+    }
+}
+
+
+TEST(StatisticBuffer, fixedSizeMatchesDynamic)
+{
+    Xerxes::StatisticBuffer<float, 64> fixed;
+    Xerxes::StatisticBuffer<float> dynamic(64);
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<float> dist(-10.0f, 10.0f);
+
+    for(int i=0; i<500; i++)
+    {
+        float sample = dist(gen);
+        fixed.insertOne(sample);
+        dynamic.insertOne(sample);
+
+        fixed.updateStatistics();
+        dynamic.updateStatistics();
+
+        EXPECT_FLOAT_EQ(fixed.getMean(), dynamic.getMean());
+        EXPECT_FLOAT_EQ(fixed.getStdDev(), dynamic.getStdDev());
+        EXPECT_FLOAT_EQ(fixed.getMin(), dynamic.getMin());
+        EXPECT_FLOAT_EQ(fixed.getMax(), dynamic.getMax());
+    }
+}
+
+
+TEST(IntStatisticBuffer, isqrt)
+{
+    for(uint64_t x : {0ULL, 1ULL, 2ULL, 3ULL, 4ULL, 99ULL, 100ULL, 101ULL, 0xFFFFFFFFULL, 1ULL << 62, ~0ULL})
+    {
+        uint64_t r = Xerxes::isqrt(x);
+        EXPECT_LE(r * r, x);
+        EXPECT_TRUE(r == 0xFFFFFFFF || (r + 1) * (r + 1) > x);
+    }
+}
+
+
+TEST(IntStatisticBuffer, matchesFloatingPoint)
+{
+    Xerxes::IntStatisticBuffer<int32_t, 128> fixedPoint;
+    Xerxes::StatisticBuffer<int32_t> reference(128);
+    std::mt19937 gen(3);
+    std::normal_distribution<double> noise(-2000000, 40);
+
+    for(int i=0; i<1000; i++)
+    {
+        int32_t sample = noise(gen);
+        fixedPoint.insertOne(sample);
+        reference.insertOne(sample);
+
+        fixedPoint.updateStatistics();
+        reference.recalculateStatistics();
+
+        float min, max, mean, stdDev;
+        fixedPoint.getStatistics(&min, &max, &mean, &stdDev);
+
+        EXPECT_NEAR(mean, reference.getMean(), 0.5);
+        EXPECT_NEAR(stdDev, reference.getStdDev(), 1.0 / 64);
+        EXPECT_EQ(fixedPoint.getMin(), reference.getMin());
+        EXPECT_EQ(fixedPoint.getMax(), reference.getMax());
+    }
+}
+
+
+TEST(IntStatisticBuffer, fullRangeStdDev)
+{
+    // largest variance of the documented range, samples alternate between +-(2^24 - 1)
+    constexpr int32_t peak = (1 << 24) - 1;
+    using Buffer = Xerxes::IntStatisticBuffer<int32_t, 16>;
+    Buffer rb;
+    for(int i=0; i<16; i++)
+    {
+        rb.insertOne(i % 2 ? peak : -peak);
+    }
+    rb.updateStatistics();
+
+    EXPECT_EQ(rb.getMeanQ(), 0);
+    EXPECT_EQ(rb.getStdDevQ(), static_cast<uint32_t>(peak) << Buffer::FRAC_BITS);
+
+    // out of range, saturates instead of wrapping around
+    for(int i=0; i<16; i++)
+    {
+        rb.insertOne(i % 2 ? 4 * peak : -4 * peak);
+    }
+    rb.updateStatistics();
+    EXPECT_EQ(rb.getStdDevQ(), UINT32_MAX);
+}
+
+
+TEST(IntStatisticBuffer, scaledStatistics)
+{
+    Xerxes::IntStatisticBuffer<int32_t> rb(10);
+    for(int i=0; i<100; i++)
+    {
+        rb.insertOne(i);
+    }
+    rb.updateStatistics();
+
+    float min, max, mean, stdDev;
+    rb.getStatistics(&min, &max, &mean, &stdDev, 0.5f);
+
+    EXPECT_FLOAT_EQ(min, 45);
+    EXPECT_FLOAT_EQ(max, 49.5);
+    EXPECT_FLOAT_EQ(mean, 47.25);
+    EXPECT_NEAR(stdDev, 2.8722813232690143 / 2, 1.0 / 256);
+}
+
+
+TEST(StatisticBank, matchesSeparateBuffers)
+{
+    Xerxes::StatisticBank<4, 64> bank;
+    Xerxes::StatisticBuffer<float> reference[4] = {
+        Xerxes::StatisticBuffer<float>(64), Xerxes::StatisticBuffer<float>(64),
+        Xerxes::StatisticBuffer<float>(64), Xerxes::StatisticBuffer<float>(64)
+    };
+    std::mt19937 gen(4);
+    std::normal_distribution<float> noise(10, 3);
+
+    // pv2 is not used
+    constexpr uint8_t mask = 0b1011;
+    float mean[4] {}, stdDev[4] {}, min[4] {}, max[4] {};
+
+    for(int i=0; i<500; i++)
+    {
+        float samples[4];
+        for(int ch=0; ch<4; ch++)
+        {
+            samples[ch] = noise(gen) * (ch + 1);
+            reference[ch].insertOne(samples[ch]);
+        }
+
+        bank.insert(samples, mask);
+        bank.publish(mean, stdDev, min, max, mask);
+
+        for(int ch=0; ch<4; ch++)
+        {
+            if(!(mask & (1 << ch)))
+            {
+                // untouched
+                EXPECT_EQ(mean[ch], 0);
+                continue;
+            }
+
+            reference[ch].recalculateStatistics();
+            EXPECT_NEAR(mean[ch], reference[ch].getMean(), 1e-3);
+            EXPECT_NEAR(stdDev[ch], reference[ch].getStdDev(), 1e-3);
+            EXPECT_EQ(min[ch], reference[ch].getMin());
+            EXPECT_EQ(max[ch], reference[ch].getMax());
+        }
+    }
+}
+
+
+TEST(StatisticBank, channelEnabledLater)
+{
+    Xerxes::StatisticBank<2, 16, int32_t> bank;
+    Xerxes::IntStatisticBuffer<int32_t, 16> reference;
+    float mean[2], stdDev[2], min[2], max[2];
+
+    for(int i=0; i<40; i++)
+    {
+        const int32_t samples[2] = {i, (i * 7919) % 101 - 50};
+        reference.insertOne(samples[1]);
+
+        // channel 1 joins after the window has wrapped
+        bank.insert(samples, i < 20 ? 0b01 : 0b11);
+    }
+
+    bank.publish(mean, stdDev, min, max, 0b11);
+    reference.updateStatistics();
+
+    float refMin, refMax, refMean, refStdDev;
+    reference.getStatistics(&refMin, &refMax, &refMean, &refStdDev);
+
+    EXPECT_FLOAT_EQ(mean[0], 31.5);
+    EXPECT_FLOAT_EQ(min[0], 24);
+    EXPECT_FLOAT_EQ(max[0], 39);
+    EXPECT_FLOAT_EQ(mean[1], refMean);
+    EXPECT_FLOAT_EQ(stdDev[1], refStdDev);
+    EXPECT_FLOAT_EQ(min[1], refMin);
+    EXPECT_FLOAT_EQ(max[1], refMax);
+    EXPECT_EQ(bank.size(), 16);
+}
+
+
+TEST(StatisticBank, insertManyMatchesInsert)
+{
+    // blocks shorter and longer than the window, after the window has filled
+    for(const uint32_t blockLen : {5u, 16u, 37u})
+    {
+        Xerxes::StatisticBank<2, 16> bank;
+        Xerxes::StatisticBank<2, 16> reference;
+        std::vector<float> rows;
+
+        for(int i=0; i<23; i++)
+        {
+            const float samples[2] = {i * 0.5f, static_cast<float>((i * 7919) % 101)};
+            bank.insert(samples, 0b11);
+            reference.insert(samples, 0b11);
+        }
+        for(uint32_t i=0; i<blockLen; i++)
+        {
+            rows.emplace_back(static_cast<float>((i * 31) % 17));
+            rows.emplace_back(-static_cast<float>(i));
+            reference.insert(&rows[2 * i], 0b11);
+        }
+        bank.insertMany(rows.data(), blockLen, 0b11);
+
+        float mean[2], stdDev[2], min[2], max[2];
+        float refMean[2], refStdDev[2], refMin[2], refMax[2];
+        bank.publish(mean, stdDev, min, max, 0b11);
+        reference.publish(refMean, refStdDev, refMin, refMax, 0b11);
+
+        for(uint8_t ch=0; ch<2; ch++)
+        {
+            EXPECT_NEAR(mean[ch], refMean[ch], 1e-4);
+            EXPECT_NEAR(stdDev[ch], refStdDev[ch], 1e-4);
+            EXPECT_FLOAT_EQ(min[ch], refMin[ch]);
+            EXPECT_FLOAT_EQ(max[ch], refMax[ch]);
+        }
+        EXPECT_EQ(bank.size(), 16);
+    }
+}
+
+
+TEST(TieredStatistics, rollUp)
+{
+    // tier 0: blocks of 5 samples, tier 1: blocks of 2 tier 0 blocks, 4 blocks per window
+    Xerxes::TieredStatistics<2, int32_t, 2, 4> tiers({5, 2});
+    float mean[2] {}, stdDev[2] {}, min[2] {}, max[2] {};
+
+    for(int32_t i=0; i<100; i++)
+    {
+        const int32_t samples[2] = {i, -i};
+        tiers.insert(samples);
+    }
+
+    // last 20 samples
+    tiers.publish(0, mean, stdDev, min, max, 0b11);
+    EXPECT_FLOAT_EQ(mean[0], 89.5);
+    EXPECT_FLOAT_EQ(stdDev[0], sqrt((20.0 * 20 - 1) / 12));
+    EXPECT_FLOAT_EQ(min[0], 80);
+    EXPECT_FLOAT_EQ(max[0], 99);
+    EXPECT_FLOAT_EQ(mean[1], -89.5);
+    EXPECT_FLOAT_EQ(min[1], -99);
+
+    // last 40 samples, only channel 0
+    tiers.publish(1, mean, stdDev, min, max, 0b01, 0.5f);
+    EXPECT_FLOAT_EQ(mean[0], 79.5 / 2);
+    EXPECT_FLOAT_EQ(stdDev[0], sqrt((40.0 * 40 - 1) / 12) / 2);
+    EXPECT_FLOAT_EQ(min[0], 30);
+    EXPECT_FLOAT_EQ(max[0], 49.5);
+    EXPECT_FLOAT_EQ(mean[1], -89.5);
+}
+
+
+TEST(TieredStatistics, largeOffset)
+{
+    // noise of +-1 on top of an offset close to the int32 limit, sums of squares of raw samples would cancel
+    Xerxes::TieredStatistics<1, int32_t, 2, 4> tiers({50, 3});
+    float mean[1] {}, stdDev[1] {};
+
+    for(int32_t i=0; i<600; i++)
+    {
+        const int32_t sample = 2'000'000'000 + (i % 2 ? 1 : -1);
+        tiers.insert(&sample);
+    }
+
+    tiers.publish(0, mean, stdDev, nullptr, nullptr, 0b1);
+    EXPECT_FLOAT_EQ(mean[0], 2e9);
+    EXPECT_NEAR(stdDev[0], 1.0, 1e-6);
+    tiers.publish(1, mean, stdDev, nullptr, nullptr, 0b1);
+    EXPECT_FLOAT_EQ(mean[0], 2e9);
+    EXPECT_NEAR(stdDev[0], 1.0, 1e-6);
+}
+
+
+TEST(TieredStatistics, emptyTierUntouched)
+{
+    Xerxes::TieredStatistics<1, float, 2, 4> tiers({10, 6});
+    float mean = -1, stdDev = -1;
+
+    for(int i=0; i<9; i++)
+    {
+        const float sample = i;
+        tiers.insert(&sample);
+    }
+
+    // no block completed yet
+    tiers.publish(0, &mean, &stdDev, nullptr, nullptr, 0b1);
+    EXPECT_EQ(mean, -1);
+
+    const float sample = 9;
+    tiers.insert(&sample);
+    tiers.publish(0, &mean, &stdDev, nullptr, nullptr, 0b1);
+    EXPECT_FLOAT_EQ(mean, 4.5);
+    EXPECT_FLOAT_EQ(stdDev, sqrt(99.0 / 12));
+}
+
+
+TEST(P2Quantile, matchesSortedWindow)
+{
+    std::mt19937 gen(8);
+    std::normal_distribution<float> noise(100, 5);
+
+    for(const float p : {0.5f, 0.95f, 0.99f})
+    {
+        Xerxes::P2Quantile estimator(p);
+        std::vector<float> samples;
+
+        for(int i=0; i<10000; i++)
+        {
+            samples.push_back(noise(gen));
+            estimator.insert(samples.back());
+        }
+
+        std::sort(samples.begin(), samples.end());
+        const float exact = samples[static_cast<size_t>(p * (samples.size() - 1))];
+
+        // within a few hundredths of sigma
+        EXPECT_NEAR(estimator.get(), exact, 0.25) << "p = " << p;
+    }
+}
+
+
+TEST(P2Quantile, fewSamples)
+{
+    Xerxes::P2Quantile median;
+    EXPECT_EQ(median.get(), 0);
+
+    for(const float x : {5.0f, 1.0f, 3.0f})
+    {
+        median.insert(x);
+    }
+    EXPECT_EQ(median.get(), 3);
+}
+
+
+TEST(StreamingQuantiles, latchesCompleteWindow)
+{
+    Xerxes::StreamingQuantiles<2, 2> quantiles({0.5f, 0.99f}, 101);
+    float out[4] {};
+
+    // channel 0 ramps 0..100, channel 1 is not used
+    for(int i=0; i<=100; i++)
+    {
+        const float samples[2] = {static_cast<float>(i), 0};
+        const bool complete = quantiles.insert(samples, 0b01);
+        EXPECT_EQ(complete, i == 100);
+
+        // nothing is published before the first window is latched
+        quantiles.publish(out, 0b01);
+        EXPECT_EQ(out[0], 0);
+    }
+    quantiles.latch();
+
+    // next window has started, published values still describe the complete one
+    const float samples[2] = {1000, 0};
+    EXPECT_FALSE(quantiles.insert(samples, 0b01));
+
+    quantiles.publish(out, 0b01, 2.0f);
+    EXPECT_NEAR(out[0], 100, 2);
+    // P2 is coarse in the tails of short windows
+    EXPECT_NEAR(out[2], 198, 6);
+    EXPECT_EQ(out[1], 0);
+    EXPECT_EQ(out[3], 0);
+}
+
+
+TEST(StreamingQuantiles, changedQuantilesRestartWindow)
+{
+    Xerxes::StreamingQuantiles<1, 1> quantiles({0.5f}, 100);
+    const float median = 0.5f, p90 = 0.9f;
+    float out = -1;
+
+    for(int i=0; i<50; i++)
+    {
+        const float sample = i;
+        quantiles.insert(&sample, 0b1);
+    }
+
+    // same quantile keeps the window, another one starts it over
+    quantiles.setQuantiles(&median);
+    for(int i=50; i<99; i++)
+    {
+        const float sample = i;
+        EXPECT_FALSE(quantiles.insert(&sample, 0b1));
+    }
+    quantiles.setQuantiles(&p90);
+    for(int i=0; i<100; i++)
+    {
+        const float sample = i;
+        EXPECT_EQ(quantiles.insert(&sample, 0b1), i == 99);
+    }
+
+    quantiles.latch();
+    quantiles.publish(&out, 0b1);
+    EXPECT_NEAR(out, 89, 3);
+}
+
+
+TEST(RingBuffer, insertManyWrapAround)
+{
+    // statistics are never updated, so insertMany() goes straight to the ring buffer
+    Xerxes::StatisticBuffer<int, 8> fixedSize;
+    Xerxes::StatisticBuffer<int> dynamic(7);
+    Xerxes::StatisticBuffer<int, 8> fixedReference;
+    Xerxes::StatisticBuffer<int> dynamicReference(7);
+
+    auto expectSameContent = [&]()
+    {
+        fixedSize.recalculateStatistics();
+        fixedReference.recalculateStatistics();
+        dynamic.recalculateStatistics();
+        dynamicReference.recalculateStatistics();
+
+        EXPECT_EQ(fixedSize.getLast(), fixedReference.getLast());
+        EXPECT_EQ(fixedSize.getMean(), fixedReference.getMean());
+        EXPECT_EQ(fixedSize.getMin(), fixedReference.getMin());
+        EXPECT_EQ(dynamic.getLast(), dynamicReference.getLast());
+        EXPECT_EQ(dynamic.getMean(), dynamicReference.getMean());
+        EXPECT_EQ(dynamic.getMin(), dynamicReference.getMin());
+    };
+
+    int next = 0;
+    // block lengths cover no wrap, wrap in the middle, exactly full and longer than the buffer
+    for(const size_t n : {3, 4, 6, 1, 7, 8, 19, 2, 5})
+    {
+        std::vector<int> block(n);
+        for(auto &el : block) el = next++;
+
+        fixedSize.insertMany(block.data(), n);
+        dynamic.insertMany(block.data(), n);
+        for(const int el : block)
+        {
+            fixedReference.insertOne(el);
+            dynamicReference.insertOne(el);
+        }
+        expectSameContent();
+    }
+
+    // following single inserts evict the same elements as after one by one inserts
+    for(int i=0; i<8; i++)
+    {
+        fixedSize.insertOne(next);
+        dynamic.insertOne(next);
+        fixedReference.insertOne(next);
+        dynamicReference.insertOne(next);
+        next++;
+        expectSameContent();
+    }
+}
+
+
+TEST(StatisticBuffer, insertManyMatchesInsertOne)
+{
+    Xerxes::StatisticBuffer<float, 16> block;
+    Xerxes::StatisticBuffer<float, 16> single;
+    Xerxes::IntStatisticBuffer<int32_t, 16> intBlock;
+    Xerxes::IntStatisticBuffer<int32_t, 16> intSingle;
+    std::mt19937 gen(10);
+    std::uniform_int_distribution<int32_t> value(-1000, 1000);
+    std::uniform_int_distribution<size_t> length(0, 20);
+
+    for(int round=0; round<200; round++)
+    {
+        const size_t n = length(gen);
+        std::vector<float> samples(n);
+        std::vector<int32_t> intSamples(n);
+        for(size_t i=0; i<n; i++)
+        {
+            intSamples[i] = value(gen);
+            samples[i] = intSamples[i] / 8.0f;
+        }
+
+        block.insertMany(samples.data(), n);
+        intBlock.insertMany(intSamples.data(), n);
+        for(size_t i=0; i<n; i++)
+        {
+            single.insertOne(samples[i]);
+            intSingle.insertOne(intSamples[i]);
+        }
+
+        block.updateStatistics();
+        single.updateStatistics();
+        intBlock.updateStatistics();
+        intSingle.updateStatistics();
+
+        EXPECT_NEAR(block.getMean(), single.getMean(), 1e-4);
+        EXPECT_NEAR(block.getStdDev(), single.getStdDev(), 1e-4);
+        EXPECT_EQ(block.getMin(), single.getMin());
+        EXPECT_EQ(block.getMax(), single.getMax());
+
+        EXPECT_EQ(intBlock.getMeanQ(), intSingle.getMeanQ());
+        EXPECT_EQ(intBlock.getStdDevQ(), intSingle.getStdDevQ());
+        EXPECT_EQ(intBlock.getMin(), intSingle.getMin());
+        EXPECT_EQ(intBlock.getMax(), intSingle.getMax());
+    }
+}
+
+
+TEST(TieredStatistics, closeBlockByTime)
+{
+    // tier 0 blocks are closed by the caller, tier 1: blocks of 2 tier 0 blocks
+    Xerxes::TieredStatistics<1, int32_t, 2, 4> tiers({0, 2});
+    float mean[1] {}, stdDev[1] {};
+
+    // 3 samples in the first block, 1 in the second, then an empty block
+    for(int32_t i : {1, 2, 3})
+    {
+        tiers.insert(&i);
+    }
+    tiers.closeBlock();
+    const int32_t last = 10;
+    tiers.insert(&last);
+    tiers.closeBlock();
+    tiers.closeBlock();
+
+    // all samples, empty block adds nothing
+    tiers.publish(0, mean, stdDev, nullptr, nullptr, 0b1);
+    EXPECT_FLOAT_EQ(mean[0], 4);
+    tiers.publish(1, mean, stdDev, nullptr, nullptr, 0b1);
+    EXPECT_FLOAT_EQ(mean[0], 4);
+}
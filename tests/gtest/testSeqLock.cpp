@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include <array>
+#include <atomic>
+#include <thread>
+#include "SeqLockBuffer.hpp"
+
+
+using namespace Xerxes;
+
+
+TEST(SeqLockBuffer, readsLastImage)
+{
+    SeqLockBuffer<16> buffer;
+    std::array<uint8_t, 16> image;
+    for(uint8_t i=0; i<16; i++) image[i] = i;
+
+    buffer.write(image.data());
+    EXPECT_EQ(buffer.version(), 1);
+
+    std::array<uint8_t, 4> out {};
+    EXPECT_EQ(buffer.read(out.data(), 4, 4), 0);
+    EXPECT_EQ(out, (std::array<uint8_t, 4>{4, 5, 6, 7}));
+}
+
+
+TEST(SeqLockBuffer, rangeWriteKeepsTheRest)
+{
+    SeqLockBuffer<16> buffer;
+    std::array<uint8_t, 16> image;
+    image.fill(1);
+    buffer.write(image.data());
+
+    // only bytes 4..7 of the new image are published
+    image.fill(2);
+    buffer.write(image.data(), 4, 4);
+    EXPECT_EQ(buffer.version(), 2);
+
+    std::array<uint8_t, 6> out {};
+    buffer.read(out.data(), 3, 6);
+    EXPECT_EQ(out, (std::array<uint8_t, 6>{1, 2, 2, 2, 2, 1}));
+}
+
+
+TEST(SeqLockBuffer, concurrentReadsAreNotTorn)
+{
+    constexpr uint32_t N = 1024;
+    static SeqLockBuffer<N> buffer;
+    std::atomic<bool> done {false};
+
+    // every image is filled with a single value, a torn read mixes two
+    std::thread writer([&]()
+    {
+        std::array<uint8_t, N> image;
+        for(uint32_t i=0; i<20000; i++)
+        {
+            image.fill(static_cast<uint8_t>(i));
+            buffer.write(image.data());
+        }
+        done = true;
+    });
+
+    std::array<uint8_t, 256> out;
+    uint32_t reads = 0;
+    while(!done || reads < 100)
+    {
+        buffer.read(out.data(), (reads * 64) % (N - out.size()), out.size());
+        for(auto byte : out)
+        {
+            ASSERT_EQ(byte, out[0]);
+        }
+        reads++;
+    }
+
+    writer.join();
+    EXPECT_EQ(buffer.version(), 20000);
+}
@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+#include "SlotTimer.hpp"
+
+
+using namespace Xerxes;
+
+
+TEST(SlotTimer, onceAfterSync)
+{
+    SlotTimer timer;
+    EXPECT_FALSE(timer.due(0, 100, true));
+
+    // slot 2 of 500 us starts 1000 us after the sync
+    timer.start(10'000, 2, 500, 0);
+    EXPECT_FALSE(timer.due(10'999, 100, true));
+    EXPECT_TRUE(timer.due(11'000, 100, true));
+    EXPECT_FALSE(timer.due(11'100, 100, true));
+    EXPECT_FALSE(timer.due(21'000, 100, true));
+}
+
+
+TEST(SlotTimer, repeatsEveryPeriod)
+{
+    SlotTimer timer;
+    timer.start(0, 1, 1'000, 10'000);
+
+    EXPECT_TRUE(timer.due(1'000, 100, true));
+    EXPECT_FALSE(timer.due(1'500, 100, true));
+    EXPECT_FALSE(timer.due(10'999, 100, true));
+    EXPECT_TRUE(timer.due(11'200, 100, true));
+
+    timer.stop();
+    EXPECT_FALSE(timer.due(21'000, 100, true));
+    EXPECT_EQ(timer.misses(), 0u);
+}
+
+
+TEST(SlotTimer, missedSlotIsSkipped)
+{
+    SlotTimer timer;
+    timer.start(0, 1, 1'000, 10'000);
+
+    // too late for slot at 1000, would collide with the next node
+    EXPECT_FALSE(timer.due(2'000, 100, true));
+    // periods in between are skipped too
+    EXPECT_FALSE(timer.due(35'000, 100, true));
+    EXPECT_TRUE(timer.due(41'000, 100, true));
+    EXPECT_EQ(timer.misses(), 2u);
+}
+
+
+TEST(SlotTimer, frameMustEndInsideSlot)
+{
+    SlotTimer timer;
+    timer.start(0, 1, 1'000, 10'000);
+
+    // slot started, but 400 us frame would end 100 us into the next slot
+    EXPECT_FALSE(timer.due(1'700, 400, true));
+    EXPECT_EQ(timer.misses(), 1u);
+
+    // ends exactly with the slot
+    EXPECT_TRUE(timer.due(11'600, 400, true));
+    EXPECT_EQ(timer.misses(), 1u);
+}
+
+
+TEST(SlotTimer, waitsForBusyTransmitter)
+{
+    SlotTimer timer;
+    timer.start(0, 1, 1'000, 10'000);
+
+    // previous frame still going out, the slot is kept while the frame fits
+    EXPECT_FALSE(timer.due(1'000, 400, false));
+    EXPECT_FALSE(timer.due(1'500, 400, false));
+    EXPECT_TRUE(timer.due(1'550, 400, true));
+    EXPECT_EQ(timer.misses(), 0u);
+
+    // transmitter busy until the frame does not fit anymore
+    EXPECT_FALSE(timer.due(11'500, 400, false));
+    EXPECT_FALSE(timer.due(11'700, 400, true));
+    EXPECT_EQ(timer.misses(), 1u);
+}
+
+
+TEST(SlotTimer, keepsSyncTime)
+{
+    SlotTimer timer;
+    timer.start(12'345, 3, 500, 0);
+    EXPECT_EQ(timer.syncUs(), 12'345u);
+}
@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <array>
+#include <span>
+#include <thread>
+#include "SpscRing.hpp"
+
+
+using namespace Xerxes;
+
+
+TEST(SpscRing, pushPopSingle)
+{
+    SpscRing<uint8_t, 4> ring;
+    uint8_t out;
+
+    EXPECT_TRUE(ring.empty());
+    EXPECT_FALSE(ring.pop(out));
+
+    for(uint8_t i=0; i<4; i++) EXPECT_TRUE(ring.push(i));
+    EXPECT_TRUE(ring.full());
+    EXPECT_FALSE(ring.push(4));
+
+    for(uint8_t i=0; i<4; i++)
+    {
+        EXPECT_TRUE(ring.pop(out));
+        EXPECT_EQ(out, i);
+    }
+    EXPECT_TRUE(ring.empty());
+}
+
+
+TEST(SpscRing, bulkWrapsAround)
+{
+    SpscRing<uint8_t, 8> ring;
+    std::array<uint8_t, 6> in {1, 2, 3, 4, 5, 6};
+    std::array<uint8_t, 6> out {};
+
+    // move the positions so the next bulk transfer wraps
+    EXPECT_EQ(ring.push(std::span<const uint8_t>(in)), 6);
+    EXPECT_EQ(ring.pop(std::span<uint8_t>(out)), 6);
+
+    EXPECT_EQ(ring.push(std::span<const uint8_t>(in)), 6);
+    EXPECT_EQ(ring.free(), 2);
+    // only what fits is pushed
+    EXPECT_EQ(ring.push(std::span<const uint8_t>(in)), 2);
+    EXPECT_TRUE(ring.full());
+
+    std::array<uint8_t, 10> all {};
+    EXPECT_EQ(ring.pop(std::span<uint8_t>(all)), 8);
+    EXPECT_EQ(all, (std::array<uint8_t, 10>{1, 2, 3, 4, 5, 6, 1, 2, 0, 0}));
+
+    ring.push(std::span<const uint8_t>(in));
+    ring.clear();
+    EXPECT_TRUE(ring.empty());
+}
+
+
+TEST(SpscRing, concurrentTransferKeepsOrder)
+{
+    constexpr uint32_t total = 200'000;
+    static SpscRing<uint8_t, 256> ring;
+
+    std::thread producer([&]()
+    {
+        std::array<uint8_t, 37> chunk;
+        uint32_t sent = 0;
+        while(sent < total)
+        {
+            uint32_t len = std::min<uint32_t>(chunk.size(), total - sent);
+            for(uint32_t i=0; i<len; i++) chunk[i] = static_cast<uint8_t>(sent + i);
+            uint32_t pushed = ring.push(std::span<const uint8_t>(chunk.data(), len));
+            // ring is full, let the consumer run if both share a core
+            if(!pushed) std::this_thread::yield();
+            sent += pushed;
+        }
+    });
+
+    std::array<uint8_t, 53> chunk;
+    uint32_t received = 0;
+    while(received < total)
+    {
+        uint32_t len = ring.pop(std::span<uint8_t>(chunk));
+        if(!len) std::this_thread::yield();
+        for(uint32_t i=0; i<len; i++)
+        {
+            ASSERT_EQ(chunk[i], static_cast<uint8_t>(received + i));
+        }
+        received += len;
+    }
+
+    producer.join();
+    EXPECT_TRUE(ring.empty());
+}